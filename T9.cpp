@@ -1,23 +1,35 @@
+#include "batch_mode.h"
+#include "dictionary.h"
+#include "dictionary_store.h"
 #include "menu_release.h"
 #include "my_exception.h"
 #include "prefix_tree.h"
+#include "trie_metrics.h"
+#include "utf8_text.h"
 #include "utf8console.h"
+#include <chrono>
+#include <clocale>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <string>
 #include <vector>
 
 /**B
  * @brief Главное текстовое меню T9.
  *
- * @param trie Ссылка на объект Trie (префиксное дерево), с которым работает
+ * @param store Словарь с сохранением изменений, с которым работает
  * пользователь.
+ * @param normalize Нормализация вводимых слов и префиксов.
  * @return short Возвращает 0 при вводе команды выхода ("/exit"), иначе цикл
  * продолжается.
  *
  * @throws EmptyInputException если строка пуста.
  * @throws WrongCommandException если команда неизвестна.B
  */
-short authMenu(Trie &trie) {
+short authMenu(DictionaryStore &store, const NormalizeOptions &normalize) {
+  Trie &trie = store.trie();
   while (true) {
     std::cout << std::endl
               << "T9_Bot 'Shark' Версия 1.0. @2025" << std::endl
@@ -27,7 +39,10 @@ short authMenu(Trie &trie) {
     std::cout << "'/sugg' для поиска автодополнений префикса" << std::endl;
     std::cout << "'/add' для добавления слова в словарь" << std::endl;
     std::cout << "'/del' для удаления слова из словаря" << std::endl;
+    std::cout << "'/t9' для набора слов цифрами клавиатуры" << std::endl;
+    std::cout << "'/fuzzy' для поиска с опечатками" << std::endl;
     std::cout << "'/print' напечатать словарь" << std::endl;
+    std::cout << "'/stats' статистика словаря и замеры запросов" << std::endl;
 
     std::string userChoice;
 
@@ -42,15 +57,25 @@ short authMenu(Trie &trie) {
 
         if (userChoice == "/sugg") {
           std::vector<std::string> results{};
-          suggMenu(trie, results);
+          suggMenu(trie, results, normalize);
           break;
         }
         if (userChoice == "/add") {
-          addMenu(trie);
+          addMenu(store, normalize);
           break;
         }
         if (userChoice == "/del") {
-          delMenu(trie);
+          delMenu(store, normalize);
+          break;
+        }
+
+        if (userChoice == "/t9") {
+          t9Menu(trie);
+          break;
+        }
+
+        if (userChoice == "/fuzzy") {
+          fuzzyMenu(trie, normalize);
           break;
         }
 
@@ -59,6 +84,11 @@ short authMenu(Trie &trie) {
           break;
         }
 
+        if (userChoice == "/stats") {
+          printDictionaryStats(trie, std::cout);
+          break;
+        }
+
         throw WrongCommandException();
 
       } catch (const MyException &ex) {
@@ -70,18 +100,10 @@ short authMenu(Trie &trie) {
 }
 
 /**
- * @brief Точка входа в приложение T9.
- *
- * @return int Возвращает 0 при успешном завершении.
- *
- * @details Инициализирует консоль в режиме UTF-8, создает дерево Trie,
- * добавляет стартовые слова, запускает главное меню.
+ * @brief Заполняет дерево стартовым набором слов.
+ * @param trie Ссылка на дерево.
  */
-int main() {
-  std::setlocale(LC_ALL, "");
-  enableUTF8Console();
-
-  Trie *trie = new Trie();
+void fillDefaultDictionary(Trie &trie) {
   std::vector<std::string> dictionary = {};
 
   dictionary.push_back("кни");
@@ -103,19 +125,235 @@ int main() {
   dictionary.push_back("рокотал");
 
   for (const std::string &word : dictionary) {
-    trie->insert(word);
+    trie.insert(word);
+  }
+}
+
+/**
+ * @brief Записывает статистику словаря и замеры в JSON.
+ * @param trie Дерево.
+ * @param path Путь к файлу ("" — не записывать, "-" — стандартный вывод
+ * ошибок).
+ */
+void dumpStats(const Trie &trie, const std::string &path) {
+  if (path.empty())
+    return;
+  if (path == "-") {
+    writeDictionaryStatsJson(trie, std::cerr);
+    return;
+  }
+  std::ofstream file(path);
+  if (!file) {
+    std::cerr << " ! Не удалось открыть файл статистики " << path << std::endl;
+    return;
+  }
+  writeDictionaryStatsJson(trie, file);
+}
+
+/**
+ * @brief Точка входа в приложение T9.
+ *
+ * @param argc Количество аргументов командной строки.
+ * @param argv Аргументы:
+ * '--snapshot <файл>' — загрузить словарь из двоичного снимка (если файла
+ * нет или он устарел, словарь строится заново и сохраняется в этот файл);
+ * добавления и удаления слов пишутся в журнал рядом со снимком и
+ * воспроизводятся при следующем запуске;
+ * '--load <файл>' — построить словарь из списка слов вместо стартового
+ * набора; '--threads <N>' — число потоков загрузки и пакетных запросов (по
+ * умолчанию все ядра); '--batch [файл]' — пакетный режим без меню (запросы
+ * из файла или стандартного ввода, ответы в TSV); '--limit <K>' — число
+ * подсказок на префикс в пакетном режиме (0 — все); '--fold-yo' — заменять
+ * ё на е в словаре и запросах; '--stats <файл>' — при выходе записать
+ * статистику словаря и замеры в JSON ("-" — в стандартный вывод ошибок);
+ * '--cache <МБ>' — кэшировать ответы на префиксы (все варианты) в пределах
+ * заданной памяти; '--backend trie|double-array|louds' — реализация словаря
+ * для пакетного режима (статические реализации строятся из --load, только
+ * отвечают на префиксы всеми вариантами и не принимают изменений).
+ * @return int Возвращает 0 при успешном завершении, 1 — если журнал словаря
+ * не удалось воспроизвести или открыть.
+ *
+ * @details Инициализирует консоль в режиме UTF-8, создает дерево Trie,
+ * загружает снимок или добавляет стартовые слова, запускает главное меню.
+ */
+int main(int argc, char **argv) {
+  std::string snapshotPath;
+  std::string wordListPath;
+  std::string statsPath;
+  std::size_t cacheMb = 0;
+  DictionaryBackend backend = DictionaryBackend::Trie;
+  std::string badBackend;
+  unsigned threads = 0;
+  bool batchMode = false;
+  BatchOptions batch;
+  NormalizeOptions normalize;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--batch") {
+      batchMode = true;
+      if (i + 1 < argc && std::string(argv[i + 1]).compare(0, 2, "--") != 0)
+        batch.inputPath = argv[++i];
+    } else if (arg == "--limit" && i + 1 < argc)
+      batch.limit = std::strtoul(argv[++i], nullptr, 10);
+    else if (arg == "--snapshot" && i + 1 < argc)
+      snapshotPath = argv[++i];
+    else if (arg == "--load" && i + 1 < argc)
+      wordListPath = argv[++i];
+    else if (arg == "--threads" && i + 1 < argc)
+      threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+    else if (arg == "--fold-yo")
+      normalize.foldYo = true;
+    else if (arg == "--stats" && i + 1 < argc)
+      statsPath = argv[++i];
+    else if (arg == "--cache" && i + 1 < argc)
+      cacheMb = std::strtoul(argv[++i], nullptr, 10);
+    else if (arg == "--backend" && i + 1 < argc) {
+      if (!parseDictionaryBackend(argv[++i], backend))
+        badBackend = argv[i];
+    }
+  }
+
+  // Отвязка от stdio допустима только до первого ввода-вывода, а
+  // enableUTF8Console уже может писать в stderr.
+  if (batchMode)
+    std::ios::sync_with_stdio(false);
+  std::setlocale(LC_ALL, "");
+  enableUTF8Console();
+  if (!badBackend.empty()) {
+    std::cerr << " ! Неизвестная реализация словаря: " << badBackend << std::endl;
+    return 1;
+  }
+
+  // В пакетном режиме стандартный вывод занят ответами, сообщения идут в stderr.
+  std::ostream &log = batchMode ? std::cerr : std::cout;
+
+  // Статические реализации только отвечают на запросы: без меню, журнала и снимка.
+  if (backend != DictionaryBackend::Trie) {
+    if (!batchMode || wordListPath.empty() || !snapshotPath.empty()) {
+      std::cerr << " ! --backend double-array|louds работает только с --batch и --load"
+                   " и без --snapshot."
+                << std::endl;
+      return 1;
+    }
+    batch.threads = threads;
+    batch.normalize = normalize;
+    try {
+      auto start = std::chrono::steady_clock::now();
+      WordListStats stats;
+      std::unique_ptr<Dictionary> dictionary =
+          loadDictionary(wordListPath, backend, threads, normalize, &stats);
+      auto elapsed = std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - start);
+      log << "Загружено слов: " << stats.words << " за " << elapsed.count() << " мс." << std::endl;
+      if (stats.rejected)
+        log << "Отклонено строк: " << stats.rejected << " (первая — строка "
+            << stats.firstRejected << ")." << std::endl;
+      return runBatch(*dictionary, batch);
+    } catch (const MyException &ex) {
+      std::cerr << " ! " << ex.what() << std::endl;
+      return 1;
+    }
+  }
+
+  Trie *trie = new Trie();
+  bool loaded = false;
+  bool fromSnapshot = false;
+
+  if (!snapshotPath.empty()) {
+    try {
+      auto start = std::chrono::steady_clock::now();
+      trie->load(snapshotPath);
+      auto elapsed = std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - start);
+      log << "Словарь загружен из снимка за " << elapsed.count() << " мс." << std::endl;
+      loaded = true;
+      fromSnapshot = true;
+    } catch (const MyException &ex) {
+      log << " ! " << ex.what() << std::endl;
+    }
   }
 
-  trie->printTrie();
+  if (!loaded && !wordListPath.empty()) {
+    try {
+      auto start = std::chrono::steady_clock::now();
+      WordListStats stats = trie->loadWordList(wordListPath, threads, normalize);
+      auto elapsed = std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - start);
+      log << "Загружено слов: " << stats.words << " за " << elapsed.count() << " мс." << std::endl;
+      if (stats.rejected)
+        log << "Отклонено строк: " << stats.rejected << " (первая — строка "
+            << stats.firstRejected << ")." << std::endl;
+      if (!batchMode)
+        trie->printMemoryUsage();
+      loaded = true;
+    } catch (const MyException &ex) {
+      log << " ! " << ex.what() << std::endl;
+    }
+  }
+
+  if (!loaded) {
+    fillDefaultDictionary(*trie);
+    if (!batchMode) {
+      trie->printTrie();
+      trie->printMemoryUsage();
+    }
+  }
+
+  trie->enableCache(cacheMb << 20);
+
+  DictionaryStore store(*trie, snapshotPath);
+  if (!snapshotPath.empty()) {
+    try {
+      RecoveryStats recovery = store.recover();
+      if (recovery.records)
+        log << "Из журнала применено записей: " << recovery.records << " за " << recovery.ms
+            << " мс." << std::endl;
+      if (recovery.discardedBytes)
+        log << "Отброшен повреждённый хвост журнала: " << recovery.discardedBytes << " байт."
+            << std::endl;
+    } catch (const MyException &ex) {
+      // Без журнала изменения не сохранились бы, а сообщалось бы об успехе.
+      std::cerr << " ! " << ex.what() << std::endl;
+      std::cerr << " ! Журнал словаря недоступен, запуск прерван." << std::endl;
+      delete trie;
+      return 1;
+    }
+  }
+
+  if (!snapshotPath.empty() && !fromSnapshot) {
+    try {
+      store.checkpoint();
+      log << "Снимок словаря сохранён: " << snapshotPath << std::endl;
+    } catch (const MyException &ex) {
+      log << " ! " << ex.what() << std::endl;
+    }
+  }
+
+  if (batchMode) {
+    int code = 1;
+    batch.threads = threads;
+    batch.normalize = normalize;
+    try {
+      code = runBatch(store, batch);
+    } catch (const MyException &ex) {
+      std::cerr << " ! " << ex.what() << std::endl;
+    }
+    store.close();
+    dumpStats(*trie, statsPath);
+    delete trie;
+    return code;
+  }
 
   short userChoice;
 
   while (true) {
-    userChoice = authMenu(*trie);
+    userChoice = authMenu(store, normalize);
     if (!userChoice)
       break;
   }
 
+  store.close();
+  dumpStats(*trie, statsPath);
   delete trie;
   return 0;
 }
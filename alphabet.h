@@ -0,0 +1,225 @@
+/**
+ * @file alphabet.h
+ * @brief Алфавиты Trie и декодирование UTF-8 в индексы символов.
+ *
+ * @details Алфавит — политика времени компиляции: список кодовых точек,
+ * из которого на этапе компиляции строятся таблица "кодовая точка ->
+ * индекс", UTF-8 написание букв и тип маски потомков узла. Символ
+ * переводится в индекс без временных строк и без ветвлений по виду
+ * алфавита. Алфавит сборки выбирается опцией CMake T9_ALPHABET.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * @brief Значение "нет кодовой точки" (ошибка или символ длиннее двух байт).
+ */
+constexpr char32_t NO_CODEPOINT = 0xFFFFFFFFu;
+
+/**
+ * @brief Декодирует очередной символ UTF-8.
+ *
+ * @details Однобайтные и двухбайтные последовательности декодируются;
+ * избыточные двухбайтные формы (ведущие байты C0, C1) отвергаются. Более
+ * длинные последовательности ни в один алфавит не входят и дают
+ * NO_CODEPOINT. Позиция сдвигается на длину символа в любом случае,
+ * кроме выхода за конец строки.
+ *
+ * @param text Строка UTF-8
+ * @param pos Позиция первого байта символа (сдвигается за символ)
+ * @return Кодовая точка или NO_CODEPOINT
+ */
+inline char32_t nextCodepoint(std::string_view text, std::size_t &pos) {
+  unsigned char b0 = static_cast<unsigned char>(text[pos]);
+
+  if (b0 < 0x80) {
+    ++pos;
+    return b0;
+  }
+
+  if ((b0 & 0xE0) == 0xC0) {
+    if (pos + 1 >= text.size())
+      return NO_CODEPOINT;
+    unsigned char b1 = static_cast<unsigned char>(text[pos + 1]);
+    pos += 2;
+    // C0 и C1 дают только избыточные (overlong) формы ASCII.
+    if ((b1 & 0xC0) != 0x80 || b0 < 0xC2)
+      return NO_CODEPOINT;
+    return (char32_t(b0 & 0x1F) << 6) | (b1 & 0x3F);
+  }
+
+  if ((b0 & 0xF0) == 0xE0)
+    pos += 3;
+  else if ((b0 & 0xF8) == 0xF0)
+    pos += 4;
+  else
+    ++pos;
+  return NO_CODEPOINT;
+}
+
+/**
+ * @struct AlphabetTables
+ * @brief Таблицы алфавита, вычисляемые на этапе компиляции.
+ * @tparam Size Число букв
+ * @tparam Limit Граница кодовых точек (все буквы ниже неё)
+ */
+template <int Size, char32_t Limit> struct AlphabetTables {
+  std::int8_t index[Limit];      ///< Кодовая точка -> индекс (-1 — нет в алфавите)
+  char symbols[Size][2];         ///< Буквы в UTF-8
+  std::uint8_t lengths[Size];    ///< Длины букв в байтах
+  std::uint32_t fingerprint;     ///< Отпечаток списка букв (FNV-1a)
+};
+
+/**
+ * @brief Наибольшая кодовая точка списка.
+ * @param letters Кодовые точки
+ * @return Наибольшая из них
+ */
+template <std::size_t N> constexpr char32_t maxCodepoint(const char32_t (&letters)[N]) {
+  char32_t result = 0;
+  for (char32_t cp : letters)
+    result = cp > result ? cp : result;
+  return result;
+}
+
+/**
+ * @brief Строит таблицы алфавита на этапе компиляции.
+ * @param letters Кодовые точки букв
+ * @return Заполненные таблицы
+ */
+template <int Size, char32_t Limit>
+constexpr AlphabetTables<Size, Limit> makeAlphabetTables(const char32_t (&letters)[Size]) {
+  AlphabetTables<Size, Limit> tables{};
+  for (char32_t cp = 0; cp < Limit; ++cp)
+    tables.index[cp] = -1;
+
+  std::uint32_t hash = 2166136261u;
+  for (int i = 0; i < Size; ++i) {
+    char32_t cp = letters[i];
+    tables.index[cp] = static_cast<std::int8_t>(i);
+    if (cp < 0x80) {
+      tables.symbols[i][0] = static_cast<char>(cp);
+      tables.lengths[i] = 1;
+    } else {
+      tables.symbols[i][0] = static_cast<char>(0xC0 | (cp >> 6));
+      tables.symbols[i][1] = static_cast<char>(0x80 | (cp & 0x3F));
+      tables.lengths[i] = 2;
+    }
+    hash = (hash ^ static_cast<std::uint32_t>(cp)) * 16777619u;
+  }
+  tables.fingerprint = hash;
+  return tables;
+}
+
+/**
+ * @class BasicAlphabet
+ * @brief Алфавит как политика времени компиляции.
+ *
+ * @details Порядок букв в списке задаёт их индексы, а значит и порядок
+ * слов при обходе дерева. Буквы должны кодироваться одним-двумя байтами
+ * UTF-8, их не больше 64 (маска потомков узла). Для алфавитов до 32 букв
+ * маска 32-битная, и узел дерева становится меньше.
+ *
+ * @tparam Letters Кодовые точки букв
+ */
+template <char32_t... Letters> class BasicAlphabet {
+public:
+  static constexpr int SIZE = sizeof...(Letters); ///< Число букв
+  static constexpr char32_t CODEPOINTS[SIZE] = {Letters...}; ///< Кодовые точки букв
+  static constexpr char32_t LIMIT = maxCodepoint(CODEPOINTS) + 1; ///< Граница таблицы
+
+  static_assert(SIZE > 0 && SIZE <= 64, "в алфавите от 1 до 64 букв");
+  static_assert(LIMIT <= 0x800, "буквы должны кодироваться не более чем двумя байтами UTF-8");
+
+  /**
+   * @brief Тип маски потомков узла.
+   */
+  using Mask = std::conditional_t<(SIZE <= 32), std::uint32_t, std::uint64_t>;
+
+  static constexpr AlphabetTables<SIZE, LIMIT> TABLES =
+      makeAlphabetTables<SIZE, LIMIT>(CODEPOINTS); ///< Таблицы алфавита
+
+  /**
+   * @brief Отпечаток алфавита для проверки совместимости файлов.
+   */
+  static constexpr std::uint32_t FINGERPRINT = TABLES.fingerprint;
+
+  /**
+   * @brief Индекс кодовой точки в алфавите.
+   * @param cp Кодовая точка
+   * @return Индекс или -1, если буквы нет в алфавите
+   */
+  static constexpr int indexOf(char32_t cp) { return cp < LIMIT ? TABLES.index[cp] : -1; }
+
+  /**
+   * @brief Декодирует очередной символ UTF-8 и возвращает его индекс.
+   * @details Позиция сдвигается так же, как в nextCodepoint.
+   * @param text Строка UTF-8
+   * @param pos Позиция первого байта символа (сдвигается за символ)
+   * @return Индекс символа или -1, если символа нет в алфавите либо
+   * последовательность некорректна
+   */
+  static int nextIndex(std::string_view text, std::size_t &pos) {
+    return indexOf(nextCodepoint(text, pos));
+  }
+
+  /**
+   * @brief Буква по индексу.
+   * @param index Индекс в алфавите
+   * @return Буква в UTF-8
+   */
+  static std::string_view symbol(int index) {
+    return std::string_view(TABLES.symbols[index], TABLES.lengths[index]);
+  }
+};
+
+#define LATIN_LETTERS                                                                            \
+  U'a', U'b', U'c', U'd', U'e', U'f', U'g', U'h', U'i', U'j', U'k', U'l', U'm', U'n', U'o',      \
+      U'p', U'q', U'r', U's', U't', U'u', U'v', U'w', U'x', U'y', U'z'
+
+#define RUSSIAN_LETTERS                                                                          \
+  U'а', U'б', U'в', U'г', U'д', U'е', U'ё', U'ж', U'з', U'и', U'й', U'к', U'л', U'м', U'н',      \
+      U'о', U'п', U'р', U'с', U'т', U'у', U'ф', U'х', U'ц', U'ч', U'ш', U'щ', U'ъ', U'ы', U'ь',  \
+      U'э', U'ю', U'я'
+
+/**
+ * @brief Латиница (a-z), 32-битная маска узла.
+ */
+using LatinAlphabet = BasicAlphabet<LATIN_LETTERS>;
+
+/**
+ * @brief Русский алфавит (а-я, ё).
+ */
+using RussianAlphabet = BasicAlphabet<RUSSIAN_LETTERS>;
+
+/**
+ * @brief Латиница и русский алфавит.
+ */
+using MixedAlphabet = BasicAlphabet<LATIN_LETTERS, RUSSIAN_LETTERS>;
+
+/**
+ * @brief Латиница и кириллица с украинскими буквами (ґ, є, і, ї), которые
+ * стоят рядом с близкими русскими.
+ */
+using UkrainianAlphabet =
+    BasicAlphabet<LATIN_LETTERS, U'а', U'б', U'в', U'г', U'ґ', U'д', U'е', U'ё', U'є', U'ж', U'з',
+                  U'и', U'і', U'ї', U'й', U'к', U'л', U'м', U'н', U'о', U'п', U'р', U'с', U'т',
+                  U'у', U'ф', U'х', U'ц', U'ч', U'ш', U'щ', U'ъ', U'ы', U'ь', U'э', U'ю', U'я'>;
+
+/**
+ * @brief Алфавит сборки (опция CMake T9_ALPHABET).
+ */
+#if defined(T9_ALPHABET_LATIN)
+using DefaultAlphabet = LatinAlphabet;
+#elif defined(T9_ALPHABET_RUSSIAN)
+using DefaultAlphabet = RussianAlphabet;
+#elif defined(T9_ALPHABET_UKRAINIAN)
+using DefaultAlphabet = UkrainianAlphabet;
+#else
+using DefaultAlphabet = MixedAlphabet;
+#endif
@@ -0,0 +1,287 @@
+/**
+ * @file batch_mode.cpp
+ * @brief Реализация пакетного режима обработки запросов.
+ */
+
+#include "batch_mode.h"
+#include "my_exception.h"
+#include "trie_metrics.h"
+#include "utf8_text.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Формирует строку ответа на префиксный запрос.
+ * @details В ответ выводится префикс в том виде, в каком он пришёл, а ищется
+ * его нормализованная форма.
+ * @param trie Словарь.
+ * @param prefix Префикс.
+ * @param options Параметры режима.
+ * @param key Рабочая строка под нормализованный префикс.
+ * @param results Рабочий вектор (переиспользуется между запросами).
+ * @param out Строка для ответа (без перевода строки).
+ */
+void answerPrefix(const Trie &trie, const std::string &prefix, const BatchOptions &options,
+                  std::string &key, std::vector<std::string> &results, std::string &out) {
+  T9_LATENCY(Metric::SuggLatency);
+  out = prefix;
+  normalizeText(prefix, key, options.normalize);
+
+  if (options.limit) {
+    trie.findTopByKey(key, options.limit, results);
+    for (const auto &word : results) {
+      out += '\t';
+      out += word;
+    }
+    return;
+  }
+
+  // С кэшем повторные префиксы отвечаются без обхода поддерева.
+  if (trie.prefixCache()) {
+    trie.findAllByKey(key, results);
+    for (const auto &word : results) {
+      out += '\t';
+      out += word;
+    }
+    return;
+  }
+
+  CompletionCursor cursor = trie.completions(key);
+  std::string word;
+  while (cursor.next(word)) {
+    out += '\t';
+    out += word;
+  }
+}
+
+/**
+ * @brief Формирует строку ответа по словарю только для чтения.
+ * @details Ответ — все слова с префиксом в порядке алфавита: у статических
+ * реализаций нет весов, поэтому limit не применяется.
+ * @param dictionary Словарь.
+ * @param prefix Префикс.
+ * @param options Параметры режима.
+ * @param key Рабочая строка под нормализованный префикс.
+ * @param results Рабочий вектор (переиспользуется между запросами).
+ * @param out Строка для ответа (без перевода строки).
+ */
+void answerPrefix(const Dictionary &dictionary, const std::string &prefix,
+                  const BatchOptions &options, std::string &key,
+                  std::vector<std::string> &results, std::string &out) {
+  T9_LATENCY(Metric::SuggLatency);
+  out = prefix;
+  normalizeText(prefix, key, options.normalize);
+  dictionary.findAllByKey(key, results);
+  for (const auto &word : results) {
+    out += '\t';
+    out += word;
+  }
+}
+
+/**
+ * @brief Отвечает на партию префиксов и пишет ответы по порядку.
+ * @tparam Source Trie или Dictionary (выбирает answerPrefix)
+ * @param source Словарь.
+ * @param prefixes Партия префиксов (очищается).
+ * @param options Параметры режима.
+ * @param output Буфер вывода.
+ */
+template <typename Source>
+void flushQueries(const Source &source, std::vector<std::string> &prefixes,
+                  const BatchOptions &options, std::string &output) {
+  if (prefixes.empty())
+    return;
+
+  std::vector<std::string> answers(prefixes.size());
+  std::atomic<std::size_t> next{0};
+  const std::size_t step = 64;
+
+  auto worker = [&]() {
+    std::vector<std::string> results;
+    std::string key;
+    for (std::size_t begin = next.fetch_add(step); begin < prefixes.size();
+         begin = next.fetch_add(step)) {
+      std::size_t end = std::min(begin + step, prefixes.size());
+      for (std::size_t i = begin; i < end; ++i)
+        answerPrefix(source, prefixes[i], options, key, results, answers[i]);
+    }
+  };
+
+  unsigned threads = options.threads;
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = static_cast<unsigned>(
+      std::min<std::size_t>(threads, (prefixes.size() + step - 1) / step));
+
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < threads; ++t)
+    pool.emplace_back(worker);
+  worker();
+  for (std::thread &thread : pool)
+    thread.join();
+
+  for (const auto &answer : answers) {
+    output += answer;
+    output += '\n';
+  }
+  prefixes.clear();
+}
+
+/**
+ * @brief Выполняет команду изменения словаря.
+ * @param store Словарь с сохранением изменений.
+ * @param line Строка команды ("/add ..." или "/del ...").
+ * @param normalize Параметры нормализации слова.
+ * @param output Буфер вывода.
+ */
+void applyCommand(DictionaryStore &store, const std::string &line,
+                  const NormalizeOptions &normalize, std::string &output) {
+  bool isAdd = line.compare(0, 5, "/add ") == 0;
+  T9_LATENCY(isAdd ? Metric::AddLatency : Metric::DelLatency);
+  std::size_t begin = line.find_first_not_of(' ', 5);
+  std::size_t end = begin == std::string::npos ? begin : line.find_first_of(" \t", begin);
+  std::string word =
+      begin == std::string::npos ? "" : normalizeWord(line.substr(begin, end - begin), normalize);
+
+  if (isAdd) {
+    std::uint32_t weight = 1;
+    bool weightOk = true;
+    std::size_t digits = end == std::string::npos ? end : line.find_first_not_of(" \t", end);
+    if (digits != std::string::npos) {
+      std::string_view field(line.c_str() + digits, line.size() - digits);
+      weightOk = parseWeight(field.substr(0, field.find_first_of(" \t")), weight);
+    }
+
+    const char *status = "ok";
+    if (!weightOk)
+      status = "invalid";
+    else if (!word.empty() && store.trie().findOneByKey(word))
+      status = "exists";
+    else if (!store.insert(word, weight))
+      status = "invalid";
+    output += "add\t" + word + '\t' + status + '\n';
+    return;
+  }
+
+  const char *status = !word.empty() && store.remove(word) ? "ok" : "missing";
+  output += "del\t" + word + '\t' + status + '\n';
+}
+
+/**
+ * @brief Открывает поток запросов.
+ * @param path Путь к файлу ("-" — стандартный ввод).
+ * @param file Поток файла (открывается, если path не "-").
+ * @return Поток, из которого читать.
+ * @throws WordListException если файл не удалось открыть.
+ */
+std::istream &openInput(const std::string &path, std::ifstream &file) {
+  if (path == "-")
+    return std::cin;
+  file.open(path);
+  if (!file)
+    throw WordListException(path, "не удалось открыть файл запросов");
+  return file;
+}
+
+} // namespace
+
+/**
+ * @brief Обрабатывает поток запросов без приглашений и диалогов.
+ * @param store Словарь с сохранением изменений.
+ * @param options Параметры режима.
+ * @return Код завершения процесса.
+ * @throws WordListException если файл запросов не удалось открыть.
+ * @throws JournalException если изменения не удалось записать в журнал.
+ */
+int runBatch(DictionaryStore &store, const BatchOptions &options) {
+  Trie &trie = store.trie();
+  std::ifstream file;
+  std::istream *input = &openInput(options.inputPath, file);
+
+  // Ответы копятся в буфере и пишутся крупными блоками.
+  const std::size_t flushBytes = 1 << 20;
+  std::string output;
+  auto drain = [&](bool force) {
+    if (force || output.size() >= flushBytes) {
+      // Об изменениях сообщается только после их записи в журнал.
+      store.sync();
+      std::cout.write(output.data(), static_cast<std::streamsize>(output.size()));
+      output.clear();
+    }
+  };
+
+  std::vector<std::string> prefixes;
+  std::string line;
+  while (std::getline(*input, line)) {
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+
+    if (line.compare(0, 5, "/add ") == 0 || line.compare(0, 5, "/del ") == 0) {
+      flushQueries(trie, prefixes, options, output);
+      applyCommand(store, line, options.normalize, output);
+      drain(false);
+      continue;
+    }
+
+    prefixes.push_back(line);
+    if (prefixes.size() >= options.chunkSize) {
+      flushQueries(trie, prefixes, options, output);
+      drain(false);
+    }
+  }
+
+  flushQueries(trie, prefixes, options, output);
+  drain(true);
+  std::cout.flush();
+  return std::cout ? 0 : 1;
+}
+
+/**
+ * @brief Обрабатывает поток запросов к словарю только для чтения.
+ * @param dictionary Словарь.
+ * @param options Параметры режима (limit не применяется).
+ * @return Код завершения процесса.
+ * @throws WordListException если файл запросов не удалось открыть.
+ */
+int runBatch(const Dictionary &dictionary, const BatchOptions &options) {
+  std::ifstream file;
+  std::istream *input = &openInput(options.inputPath, file);
+
+  std::vector<std::string> prefixes;
+  std::string output;
+  std::string line;
+  while (std::getline(*input, line)) {
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+
+    bool isAdd = line.compare(0, 5, "/add ") == 0;
+    if (isAdd || line.compare(0, 5, "/del ") == 0) {
+      flushQueries(dictionary, prefixes, options, output);
+      std::size_t begin = line.find_first_not_of(' ', 5);
+      std::size_t end = begin == std::string::npos ? begin : line.find_first_of(" \t", begin);
+      std::string word = begin == std::string::npos
+                             ? ""
+                             : normalizeWord(line.substr(begin, end - begin), options.normalize);
+      output += (isAdd ? "add\t" : "del\t") + word + "\treadonly\n";
+      continue;
+    }
+
+    prefixes.push_back(line);
+    if (prefixes.size() >= options.chunkSize) {
+      flushQueries(dictionary, prefixes, options, output);
+      std::cout.write(output.data(), static_cast<std::streamsize>(output.size()));
+      output.clear();
+    }
+  }
+
+  flushQueries(dictionary, prefixes, options, output);
+  std::cout.write(output.data(), static_cast<std::streamsize>(output.size()));
+  std::cout.flush();
+  return std::cout ? 0 : 1;
+}
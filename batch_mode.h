@@ -0,0 +1,67 @@
+/**
+ * @file batch_mode.h
+ * @brief Неинтерактивный пакетный режим обработки запросов.
+ */
+
+#pragma once
+
+#include "dictionary.h"
+#include "dictionary_store.h"
+#include "prefix_tree.h"
+#include "utf8_text.h"
+#include <cstddef>
+#include <string>
+
+/**
+ * @struct BatchOptions
+ * @brief Параметры пакетного режима.
+ */
+struct BatchOptions {
+  std::string inputPath = "-"; ///< Файл запросов ("-" — стандартный ввод)
+  std::size_t limit = 5;       ///< Число подсказок на префикс (0 — все, по алфавиту)
+  unsigned threads = 1;        ///< Потоки для запросов (0 — по числу ядер)
+  std::size_t chunkSize = 65536; ///< Сколько запросов подряд обрабатывать одной партией
+  NormalizeOptions normalize;    ///< Нормализация префиксов и слов команд
+};
+
+/**
+ * @brief Обрабатывает поток запросов без приглашений и диалогов.
+ *
+ * @details Каждая строка входа — либо префикс, либо команда изменения
+ * словаря: "/add слово [вес]" или "/del слово". На каждую строку выводится
+ * ровно одна строка TSV:
+ * - префикс: "префикс<TAB>слово1<TAB>слово2...";
+ * - /add: "add<TAB>слово<TAB>ok|exists|invalid" (invalid — недопустимое
+ *   слово или вес, не являющийся неотрицательным целым числом);
+ * - /del: "del<TAB>слово<TAB>ok|missing".
+ *
+ * Вывод буферизуется. Подряд идущие префиксы обрабатываются партиями:
+ * дерево в это время только читается, и партия распределяется по потокам.
+ * Команды изменения выполняются строго по порядку между партиями.
+ * Префиксы и слова команд нормализуются так же, как список слов
+ * (normalizeText); в ответе префикс выводится в исходном виде. Изменения
+ * идут через хранилище: ответы на команды выводятся только после того, как
+ * изменения сброшены в журнал (одним fsync на группу).
+ *
+ * @param store Словарь с сохранением изменений
+ * @param options Параметры режима
+ * @return Код завершения процесса (0 — успех)
+ * @throws WordListException если файл запросов не удалось открыть
+ * @throws JournalException если изменения не удалось записать в журнал
+ */
+int runBatch(DictionaryStore &store, const BatchOptions &options);
+
+/**
+ * @brief Обрабатывает поток запросов к словарю только для чтения.
+ *
+ * @details Формат входа и выхода тот же, что у runBatch для хранилища, но
+ * на префикс выводятся все слова в порядке алфавита (limit не
+ * применяется: у статических реализаций нет весов), а команды изменения
+ * не выполняются и получают ответ "add|del<TAB>слово<TAB>readonly".
+ *
+ * @param dictionary Словарь
+ * @param options Параметры режима
+ * @return Код завершения процесса (0 — успех)
+ * @throws WordListException если файл запросов не удалось открыть
+ */
+int runBatch(const Dictionary &dictionary, const BatchOptions &options);
@@ -0,0 +1,525 @@
+/**
+ * @file trie_bench.cpp
+ * @brief Бенчмарк префиксного дерева: подготовка текста, вставка, поиск,
+ * автодополнение, удаление и разрушение на синтетическом или файловом словаре.
+ *
+ * @details Результат печатается в JSON: на каждую операцию — число
+ * операций, пропускная способность и перцентили задержки; в конце —
+ * пиковый RSS процесса. Пример:
+ * @code
+ * ./T9Bench --words 1000000 --alphabet mixed --queries 20000 > result.json
+ * @endcode
+ */
+
+#include "double_array.h"
+#include "louds_trie.h"
+#include "my_exception.h"
+#include "prefix_tree.h"
+#include "sharded_trie.h"
+#include "utf8_text.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @struct BenchConfig
+ * @brief Параметры запуска бенчмарка.
+ */
+struct BenchConfig {
+  std::size_t words = 200000;     ///< Размер синтетического словаря
+  std::string alphabet = "mixed"; ///< Буквы алфавита сборки: ru, en или mixed (все)
+  std::string file;               ///< Файл словаря (вместо синтетики)
+  std::size_t queries = 20000;    ///< Число запросов на каждый замер
+  std::size_t topK = 5;           ///< k для findTopByKey и findFuzzyByKey
+  unsigned seed = 42;             ///< Зерно генератора
+  DictionaryBackend backend = DictionaryBackend::Trie; ///< Реализация для findOne/findAll
+};
+
+/**
+ * @struct OpStats
+ * @brief Результат замера одной операции.
+ */
+struct OpStats {
+  std::string name;                ///< Имя операции
+  std::vector<std::int64_t> nanos; ///< Задержки отдельных операций
+  double totalMs = 0;              ///< Общее время замера
+  std::size_t items = 0;           ///< Доп. счётчик (найдено слов и т.п.)
+  std::size_t bytes = 0;           ///< Обработано байт (для операций над текстом)
+};
+
+/**
+ * @brief Текущий пиковый RSS процесса.
+ * @return Пиковый RSS в КБ (0, если недоступно)
+ */
+long peakRssKb() {
+#if !defined(_WIN32)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) == 0)
+    return usage.ru_maxrss;
+#endif
+  return 0;
+}
+
+/**
+ * @brief Генерирует синтетический словарь.
+ * @param config Параметры
+ * @return Уникальные слова с весами
+ */
+std::vector<WordEntry> generateWords(const BenchConfig &config) {
+  std::vector<std::string> letters;
+  for (int i = 0; i < DefaultAlphabet::SIZE; ++i) {
+    bool latin = DefaultAlphabet::CODEPOINTS[i] < 0x80;
+    if ((config.alphabet == "en" && !latin) || (config.alphabet == "ru" && latin))
+      continue;
+    letters.push_back(std::string(DefaultAlphabet::symbol(i)));
+  }
+  if (letters.empty())
+    letters.push_back(std::string(DefaultAlphabet::symbol(0)));
+
+  std::mt19937 rng(config.seed);
+  // Частоты букв убывают геометрически, как в живом языке.
+  std::vector<double> freq;
+  for (std::size_t i = 0; i < letters.size(); ++i)
+    freq.push_back(1.0 / (1.0 + 0.3 * static_cast<double>((i * 7) % letters.size())));
+  std::discrete_distribution<std::size_t> letter(freq.begin(), freq.end());
+  std::uniform_int_distribution<int> length(3, 12);
+  std::geometric_distribution<std::uint32_t> weight(0.01);
+
+  std::unordered_set<std::string> seen;
+  std::vector<WordEntry> words;
+  words.reserve(config.words);
+  while (words.size() < config.words) {
+    std::string word;
+    for (int n = length(rng); n > 0; --n)
+      word += letters[letter(rng)];
+    if (seen.insert(word).second)
+      words.push_back({word, 1 + weight(rng)});
+  }
+  return words;
+}
+
+/**
+ * @brief Читает словарь из файла (формат как у --load).
+ * @param path Путь к файлу
+ * @return Слова с весами
+ * @throws WordListException если файл не удалось открыть
+ */
+std::vector<WordEntry> readWords(const std::string &path) {
+  std::ifstream file(path);
+  if (!file)
+    throw WordListException(path, "не удалось открыть файл");
+
+  std::vector<WordEntry> words;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream fields(line);
+    WordEntry entry{"", 1};
+    if (fields >> entry.word) {
+      fields >> entry.weight;
+      words.push_back(entry);
+    }
+  }
+  return words;
+}
+
+/**
+ * @brief Первые n символов UTF-8 строки.
+ * @param word Слово
+ * @param n Число символов
+ * @return Префикс
+ */
+std::string utf8Prefix(const std::string &word, std::size_t n) {
+  std::size_t pos = 0;
+  for (std::size_t i = 0; i < n && pos < word.size(); ++i)
+    DefaultAlphabet::nextIndex(word, pos);
+  return word.substr(0, pos);
+}
+
+/**
+ * @brief Замеряет операцию над каждым элементом набора.
+ * @param name Имя операции
+ * @param count Число операций
+ * @param op Операция, получающая номер итерации и возвращающая доп. счётчик
+ * @return Результат замера
+ */
+template <typename Op> OpStats measure(const std::string &name, std::size_t count, Op op) {
+  OpStats stats;
+  stats.name = name;
+  stats.nanos.reserve(count);
+
+  Clock::time_point begin = Clock::now();
+  for (std::size_t i = 0; i < count; ++i) {
+    Clock::time_point start = Clock::now();
+    stats.items += op(i);
+    stats.nanos.push_back(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+  }
+  stats.totalMs = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+  return stats;
+}
+
+/**
+ * @brief Замеряет операцию, выполняемую одновременно из нескольких потоков.
+ * @details Пропускная способность считается по общему времени от запуска
+ * первого потока до завершения последнего.
+ * @param name Имя операции
+ * @param threads Число потоков
+ * @param count Число операций на поток
+ * @param op Операция, получающая номер потока и итерации и возвращающая доп. счётчик
+ * @return Результат замера (задержки всех потоков)
+ */
+template <typename Op>
+OpStats measureConcurrent(const std::string &name, unsigned threads, std::size_t count, Op op) {
+  std::vector<OpStats> parts(threads);
+  Clock::time_point begin = Clock::now();
+  std::vector<std::thread> pool;
+  for (unsigned t = 0; t < threads; ++t)
+    pool.emplace_back([&, t]() { parts[t] = measure(name, count, [&](std::size_t i) { return op(t, i); }); });
+  for (std::thread &thread : pool)
+    thread.join();
+
+  OpStats stats;
+  stats.name = name;
+  stats.totalMs = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+  for (const OpStats &part : parts) {
+    stats.nanos.insert(stats.nanos.end(), part.nanos.begin(), part.nanos.end());
+    stats.items += part.items;
+  }
+  return stats;
+}
+
+/**
+ * @brief Печатает результат замера как объект JSON.
+ * @param stats Результат
+ * @param last Последний элемент массива
+ */
+void printStats(OpStats &stats, bool last) {
+  std::sort(stats.nanos.begin(), stats.nanos.end());
+  auto percentile = [&](double p) -> std::int64_t {
+    if (stats.nanos.empty())
+      return 0;
+    std::size_t index = static_cast<std::size_t>(p * static_cast<double>(stats.nanos.size() - 1));
+    return stats.nanos[index];
+  };
+
+  std::size_t count = stats.nanos.size();
+  std::cout << "    {\"op\": \"" << stats.name << "\", \"count\": " << count
+            << ", \"total_ms\": " << stats.totalMs << ", \"ops_per_sec\": "
+            << (stats.totalMs > 0 ? static_cast<double>(count) * 1000.0 / stats.totalMs : 0)
+            << ", \"p50_ns\": " << percentile(0.50) << ", \"p90_ns\": " << percentile(0.90)
+            << ", \"p99_ns\": " << percentile(0.99) << ", \"max_ns\": " << percentile(1.0)
+            << ", \"items\": " << stats.items;
+  if (stats.bytes)
+    std::cout << ", \"gb_per_sec\": "
+              << (stats.totalMs > 0 ? static_cast<double>(stats.bytes) / stats.totalMs / 1e6 : 0);
+  std::cout << "}" << (last ? "" : ",") << std::endl;
+}
+
+/**
+ * @brief Разбирает аргументы командной строки.
+ * @param argc Количество аргументов
+ * @param argv Аргументы
+ * @param config Параметры для заполнения
+ * @return false, если аргументы некорректны
+ */
+bool parseArgs(int argc, char **argv, BenchConfig &config) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (i + 1 >= argc)
+      return false;
+    std::string value = argv[++i];
+    if (arg == "--words")
+      config.words = std::strtoul(value.c_str(), nullptr, 10);
+    else if (arg == "--alphabet")
+      config.alphabet = value;
+    else if (arg == "--file")
+      config.file = value;
+    else if (arg == "--queries")
+      config.queries = std::strtoul(value.c_str(), nullptr, 10);
+    else if (arg == "--top")
+      config.topK = std::strtoul(value.c_str(), nullptr, 10);
+    else if (arg == "--seed")
+      config.seed = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+    else if (arg == "--backend") {
+      if (!parseDictionaryBackend(value, config.backend))
+        return false;
+    } else
+      return false;
+  }
+  return config.alphabet == "ru" || config.alphabet == "en" || config.alphabet == "mixed";
+}
+
+} // namespace
+
+/**
+ * @brief Точка входа бенчмарка.
+ * @param argc Количество аргументов.
+ * @param argv Аргументы: --words N, --alphabet ru|en|mixed, --file путь,
+ * --queries Q, --top K, --seed S, --backend trie|double-array|louds.
+ * @return 0 при успехе, 1 при ошибке аргументов или чтения файла.
+ */
+int main(int argc, char **argv) {
+  BenchConfig config;
+  if (!parseArgs(argc, argv, config)) {
+    std::cerr << "Использование: T9Bench [--words N] [--alphabet ru|en|mixed] [--file путь]"
+                 " [--queries Q] [--top K] [--seed S] [--backend trie|double-array|louds]"
+              << std::endl;
+    return 1;
+  }
+
+  std::vector<WordEntry> words;
+  try {
+    words = config.file.empty() ? generateWords(config) : readWords(config.file);
+  } catch (const MyException &ex) {
+    std::cerr << " ! " << ex.what() << std::endl;
+    return 1;
+  }
+  if (words.empty()) {
+    std::cerr << " ! Пустой словарь." << std::endl;
+    return 1;
+  }
+
+  std::mt19937 rng(config.seed + 1);
+  std::vector<std::size_t> sample(config.queries);
+  for (auto &index : sample)
+    index = rng() % words.size();
+
+  std::vector<OpStats> results;
+
+  // Проверка и нормализация текста словаря (как при загрузке списка слов):
+  // векторный и скалярный варианты на одном буфере не меньше 16 МБ.
+  std::string text;
+  while (text.size() < (16u << 20))
+    for (const WordEntry &entry : words) {
+      text += entry.word;
+      text += '\n';
+    }
+  std::string normalized;
+  const std::size_t passes = 8;
+  auto measureText = [&](const std::string &name, auto op) {
+    OpStats stats = measure(name, passes, [&](std::size_t) { return op(); });
+    stats.bytes = passes * text.size();
+    results.push_back(std::move(stats));
+  };
+  measureText("utf8/validate", [&]() { return isValidUtf8(text) ? 1 : 0; });
+  measureText("utf8/validate-scalar", [&]() { return isValidUtf8Scalar(text) ? 1 : 0; });
+  measureText("utf8/normalize", [&]() {
+    normalizeText(text, normalized);
+    return 0;
+  });
+  measureText("utf8/normalize-scalar", [&]() {
+    normalizeTextScalar(text, normalized);
+    return 0;
+  });
+  std::string().swap(text);
+  std::string().swap(normalized);
+
+  long rssBefore = peakRssKb();
+  Trie *trie = new Trie();
+
+  results.push_back(measure("insert", words.size(), [&](std::size_t i) {
+    trie->insert(words[i].word, words[i].weight);
+    return 0;
+  }));
+  long rssBuilt = peakRssKb();
+
+  // Точный и префиксный поиск идут через выбранную реализацию словаря.
+  std::unique_ptr<Dictionary> encoded;
+  const Dictionary *reader = trie;
+  if (config.backend == DictionaryBackend::DoubleArray) {
+    results.push_back(measure("build/double-array", 1, [&](std::size_t) {
+      DoubleArrayTrie *doubleArray = new DoubleArrayTrie(*trie);
+      encoded.reset(doubleArray);
+      return doubleArray->size();
+    }));
+  } else if (config.backend == DictionaryBackend::Louds) {
+    results.push_back(measure("build/louds", 1, [&](std::size_t) {
+      LoudsTrie *louds = new LoudsTrie(*trie);
+      encoded.reset(louds);
+      return louds->size();
+    }));
+  }
+  if (encoded)
+    reader = encoded.get();
+
+  results.push_back(measure("findOneByKey", sample.size(), [&](std::size_t i) {
+    return reader->findOneByKey(words[sample[i]].word) ? 1 : 0;
+  }));
+
+  std::vector<std::string> found;
+  for (std::size_t length = 1; length <= 4; ++length) {
+    std::vector<std::string> prefixes;
+    for (std::size_t index : sample)
+      prefixes.push_back(utf8Prefix(words[index].word, length));
+
+    std::size_t count = std::min<std::size_t>(prefixes.size(), length == 1 ? 200 : 2000);
+    results.push_back(measure("findAllByKey/prefix" + std::to_string(length), count,
+                              [&](std::size_t i) {
+                                reader->findAllByKey(prefixes[i], found);
+                                return found.size();
+                              }));
+    results.push_back(measure("findTopByKey/prefix" + std::to_string(length), prefixes.size(),
+                              [&](std::size_t i) {
+                                trie->findTopByKey(prefixes[i], config.topK, found);
+                                return found.size();
+                              }));
+  }
+
+  // Повторяющиеся короткие префиксы (длины 2–3 с частотой по закону Ципфа)
+  // через кэш префиксов: первый запрос обходит поддерево, повторные
+  // отвечаются из кэша. Счётчики кэша выводятся в "prefix_cache".
+  std::vector<std::string> hotPrefixes;
+  for (std::size_t index : sample)
+    hotPrefixes.push_back(utf8Prefix(words[index].word, 2 + index % 2));
+  std::vector<double> zipf;
+  for (std::size_t i = 0; i < hotPrefixes.size(); ++i)
+    zipf.push_back(1.0 / static_cast<double>(i + 1));
+  std::discrete_distribution<std::size_t> hot(zipf.begin(), zipf.end());
+  std::vector<std::size_t> hotQueries(config.queries);
+  for (auto &index : hotQueries)
+    index = hot(rng);
+
+  for (std::size_t cacheMb : {0, 64}) {
+    trie->enableCache(cacheMb << 20);
+    results.push_back(measure(cacheMb ? "findAllByKey/hot-cached" : "findAllByKey/hot",
+                              hotQueries.size(), [&](std::size_t i) {
+                                trie->findAllByKey(hotPrefixes[hotQueries[i]], found);
+                                return found.size();
+                              }));
+  }
+  PrefixCacheStats cacheStats = trie->prefixCache()->stats();
+  trie->enableCache(0);
+
+  // Опечатка — пропущенный второй символ; расстояние как в меню /fuzzy.
+  std::vector<FuzzyMatch> fuzzy;
+  for (std::size_t length : {4, 6}) {
+    std::vector<std::string> typos;
+    for (std::size_t index : sample) {
+      const std::string &word = words[index].word;
+      typos.push_back(utf8Prefix(utf8Prefix(word, 1) + word.substr(utf8Prefix(word, 2).size()),
+                                 length));
+    }
+
+    unsigned distance = length < 6 ? 1 : 2;
+    std::size_t count = std::min<std::size_t>(typos.size(), 2000);
+    results.push_back(measure("findFuzzyByKey/prefix" + std::to_string(length), count,
+                              [&](std::size_t i) {
+                                trie->findFuzzyByKey(typos[i], distance, config.topK, fuzzy);
+                                return fuzzy.size();
+                              }));
+  }
+
+  std::vector<std::string> victims;
+  for (std::size_t index : sample)
+    victims.push_back(words[index].word);
+  std::sort(victims.begin(), victims.end());
+  victims.erase(std::unique(victims.begin(), victims.end()), victims.end());
+  results.push_back(measure("delWord", victims.size(), [&](std::size_t i) {
+    if (!trie->findOneByKey(victims[i]))
+      return 0;
+    trie->delWord(trie->getRoot(), victims[i], 0);
+    return 1;
+  }));
+
+  // Удаления освобождают узлы в списки свободных; compact собирает живые
+  // узлы подряд. Результат — число живых узлов после уплотнения.
+  ArenaUsage churned = trie->nodeUsage();
+  results.push_back(measure("compact", 1, [&](std::size_t) {
+    trie->compact();
+    return trie->nodeUsage().liveNodes;
+  }));
+
+  results.push_back(measure("teardown", 1, [&](std::size_t) {
+    delete trie;
+    return 0;
+  }));
+
+  // Смешанная нагрузка из нескольких потоков: на каждые 10 операций одна
+  // вставка и 9 поисков лучших k по префиксу из 2 символов. Словарь заранее
+  // заполнен половиной слов, вставляется вторая половина. Шардированный
+  // словарь сравнивается с одним деревом под одной блокировкой
+  // (ShardedTrie с одним шардом).
+  std::size_t half = words.size() / 2;
+  std::vector<std::string> prefixes2;
+  for (std::size_t index : sample)
+    prefixes2.push_back(utf8Prefix(words[index].word, 2));
+  unsigned maxThreads = std::max(4u, std::thread::hardware_concurrency());
+  for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+    for (unsigned shards : {1u, 0u}) {
+      ShardedTrie dictionary(shards);
+      std::vector<std::vector<std::string>> top(threads);
+      for (std::size_t i = 0; i < half; ++i)
+        dictionary.insert(words[i].word, words[i].weight);
+
+      std::string name = std::string("concurrent/") + (shards ? "single-lock" : "sharded") +
+                         "/t" + std::to_string(threads);
+      results.push_back(measureConcurrent(
+          name, threads, prefixes2.size(), [&](unsigned t, std::size_t i) -> std::size_t {
+            if (i % 10 == 0) {
+              const WordEntry &entry =
+                  words[half + (t * prefixes2.size() / 10 + i / 10) % (words.size() - half)];
+              return dictionary.insert(entry.word, entry.weight) ? 1 : 0;
+            }
+            dictionary.findTopByKey(prefixes2[(i + t * 7919) % prefixes2.size()], config.topK,
+                                    top[t]);
+            return top[t].size();
+          }));
+    }
+  }
+
+#if defined(NDEBUG)
+  const char *buildType = "release";
+#else
+  const char *buildType = "debug";
+#endif
+
+  std::cout << "{" << std::endl
+            << "  \"config\": {\"words\": " << words.size() << ", \"alphabet\": \""
+            << (config.file.empty() ? config.alphabet : "file") << "\", \"file\": \""
+            << config.file << "\", \"queries\": " << config.queries
+            << ", \"top_k\": " << config.topK << ", \"seed\": " << config.seed
+            << ", \"backend\": \""
+            << (config.backend == DictionaryBackend::DoubleArray ? "double-array"
+                : config.backend == DictionaryBackend::Louds     ? "louds"
+                                                                 : "trie")
+            << "\", \"build\": \"" << buildType << "\", \"node_bytes\": " << sizeof(Trie::Node)
+            << "}," << std::endl
+            << "  \"results\": [" << std::endl;
+  for (std::size_t i = 0; i < results.size(); ++i)
+    printStats(results[i], i + 1 == results.size());
+  std::cout << "  ]," << std::endl
+            << "  \"memory\": {\"rss_before_kb\": " << rssBefore
+            << ", \"rss_after_build_kb\": " << rssBuilt << ", \"peak_rss_kb\": " << peakRssKb()
+            << "}," << std::endl
+            << "  \"arena_after_delete\": {\"live_nodes\": " << churned.liveNodes
+            << ", \"dead_nodes\": " << churned.deadNodes << ", \"dead_links\": " << churned.deadLinks
+            << "}," << std::endl
+            << "  \"prefix_cache\": {\"hits\": " << cacheStats.hits
+            << ", \"misses\": " << cacheStats.misses << ", \"hit_rate\": "
+            << static_cast<double>(cacheStats.hits) /
+                   static_cast<double>(std::max<std::uint64_t>(1, cacheStats.hits + cacheStats.misses))
+            << ", \"saved_nodes\": " << cacheStats.savedNodes
+            << ", \"saved_ms\": " << cacheStats.savedNanos / 1e6
+            << ", \"evictions\": " << cacheStats.evictions << ", \"entries\": " << cacheStats.entries
+            << ", \"bytes\": " << cacheStats.bytes << "}" << std::endl
+            << "}" << std::endl;
+  return 0;
+}
@@ -0,0 +1,259 @@
+/**
+ * @file bulk_load.cpp
+ * @brief Параллельная пакетная загрузка слов в Trie.
+ */
+
+#include "my_exception.h"
+#include "prefix_tree.h"
+#include "utf8_text.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+/**
+ * @brief Размер блока чтения списка слов, байт.
+ */
+constexpr std::size_t READ_CHUNK = 1 << 20;
+
+/**
+ * @brief Слово группы, хранимое по значению.
+ * @param entry Слово.
+ * @return Ссылка на слово.
+ */
+const WordEntry &entryOf(const WordEntry &entry) { return entry; }
+
+/**
+ * @brief Слово группы, хранимое по указателю.
+ * @param entry Указатель на слово.
+ * @return Ссылка на слово.
+ */
+const WordEntry &entryOf(const WordEntry *entry) { return *entry; }
+
+} // namespace
+
+/**
+ * @brief Строит поддеревья групп параллельно и подвешивает их под корень.
+ * @param buckets Группы слов по индексу первого символа (Alphabet::SIZE штук).
+ * @param threads Число потоков (0 — по числу ядер).
+ */
+template <typename Alphabet>
+template <typename Entry>
+void BasicTrie<Alphabet>::insertBuckets(const std::vector<Entry> *buckets, unsigned threads) {
+  keypad.reset();
+  if (cache)
+    cache->clear();
+
+  // Крупные группы — первыми, чтобы потоки заканчивали примерно одновременно.
+  std::vector<int> order;
+  for (int i = 0; i < Alphabet::SIZE; ++i)
+    if (!buckets[i].empty())
+      order.push_back(i);
+  std::sort(order.begin(), order.end(),
+            [&](int a, int b) { return buckets[a].size() > buckets[b].size(); });
+
+  std::unique_ptr<BasicTrie> parts[Alphabet::SIZE];
+  std::atomic<std::size_t> next{0};
+
+  auto worker = [&]() {
+    for (std::size_t i = next++; i < order.size(); i = next++) {
+      int index = order[i];
+      if (arena.getChild(root, index) != NO_NODE)
+        continue;
+      parts[index].reset(new BasicTrie());
+      for (const Entry &entry : buckets[index])
+        parts[index]->insert(entryOf(entry).word, entryOf(entry).weight);
+    }
+  };
+
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = static_cast<unsigned>(std::min<std::size_t>(threads, order.size()));
+
+  std::vector<std::thread> pool;
+  for (unsigned t = 1; t < threads; ++t)
+    pool.emplace_back(worker);
+  worker();
+  for (std::thread &thread : pool)
+    thread.join();
+
+  std::size_t nodes = arena.nodeCount(), links = arena.linkCount();
+  for (int index : order) {
+    if (parts[index]) {
+      nodes += parts[index]->arena.nodeCount();
+      links += parts[index]->arena.linkCount();
+    }
+  }
+  arena.reserve(nodes, links);
+
+  for (int index : order) {
+    if (!parts[index]) {
+      for (const Entry &entry : buckets[index])
+        insert(entryOf(entry).word, entryOf(entry).weight);
+      continue;
+    }
+
+    NodeId subRoot = arena.graft(parts[index]->arena, parts[index]->root);
+    parts[index].reset();
+
+    NodeId child = arena.getChild(subRoot, index);
+    arena.removeChild(subRoot, index);
+    arena.freeNode(subRoot);
+    arena.addChild(root, index, child);
+    arena.node(root).maxWeight =
+        std::max(arena.node(root).maxWeight, arena.node(child).maxWeight);
+    arena.node(root).words += arena.node(child).words;
+  }
+}
+
+/**
+ * @brief Пакетно вставляет слова, строя поддеревья параллельно.
+ * @param words Слова с весами.
+ * @param threads Число потоков (0 — по числу ядер).
+ */
+template <typename Alphabet>
+void BasicTrie<Alphabet>::bulkInsert(const std::vector<WordEntry> &words, unsigned threads) {
+  std::vector<const WordEntry *> buckets[Alphabet::SIZE];
+  for (const WordEntry &entry : words) {
+    // Недопустимые слова insert всё равно отверг бы; отбрасываются здесь,
+    // чтобы не строить пустых поддеревьев.
+    if (!isValidWord(entry.word))
+      continue;
+    std::size_t pos = 0;
+    buckets[Alphabet::nextIndex(entry.word, pos)].push_back(&entry);
+  }
+  insertBuckets(buckets, threads);
+}
+
+/**
+ * @brief Загружает слова из текстового файла UTF-8.
+ *
+ * @details Файл читается блоками по READ_CHUNK байт; неполная последняя
+ * строка блока переносится в следующий. Каждый блок целых строк
+ * проверяется как UTF-8 и нормализуется векторными проходами целиком, а
+ * если он некорректен, каждая строка проверяется и нормализуется отдельно:
+ * так находятся плохие строки. Принятые слова сразу раскладываются по
+ * группам первого символа, и в памяти одновременно не бывает ни всего
+ * файла, ни его нормализованной копии.
+ *
+ * @param path Путь к файлу.
+ * @param threads Число потоков (0 — по числу ядер).
+ * @param normalize Параметры нормализации.
+ * @return Число принятых и отклонённых слов.
+ * @throws WordListException если файл не удалось открыть.
+ */
+template <typename Alphabet>
+WordListStats BasicTrie<Alphabet>::loadWordList(const std::string &path, unsigned threads,
+                                                const NormalizeOptions &normalize) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    throw WordListException(path, "не удалось открыть файл");
+
+  WordListStats stats;
+  std::vector<WordEntry> buckets[Alphabet::SIZE];
+  std::size_t lineNumber = 0;
+
+  auto reject = [&]() {
+    if (stats.rejected++ == 0)
+      stats.firstRejected = lineNumber;
+  };
+
+  // Разбирает нормализованную строку и кладёт слово в его группу.
+  auto addLine = [&](std::string_view line) {
+    if (!line.empty() && line.back() == '\r')
+      line.remove_suffix(1);
+
+    std::size_t split = line.find_first_of(" \t");
+    std::string_view word = line.substr(0, split);
+    if (word.empty())
+      return;
+
+    std::uint32_t weight = 1;
+    if (split != std::string_view::npos) {
+      std::size_t digits = line.find_first_not_of(" \t", split);
+      if (digits != std::string_view::npos) {
+        std::string_view field = line.substr(digits);
+        if (!parseWeight(field.substr(0, field.find_first_of(" \t")), weight))
+          return reject();
+      }
+    }
+
+    if (!isValidWord(word))
+      return reject();
+    std::size_t pos = 0;
+    buckets[Alphabet::nextIndex(word, pos)].push_back(WordEntry{std::string(word), weight});
+    ++stats.words;
+  };
+
+  // Обрабатывает блок целых строк (без завершающего перевода строки).
+  std::string text;
+  auto addLines = [&](std::string_view block) {
+    bool valid = isValidUtf8(block);
+    if (valid)
+      normalizeText(block, text, normalize);
+    std::string_view source = valid ? std::string_view(text) : block;
+
+    for (std::size_t begin = 0, end = 0; end != std::string_view::npos; begin = end + 1) {
+      end = source.find('\n', begin);
+      std::string_view line = source.substr(begin, end == std::string_view::npos ? end : end - begin);
+      ++lineNumber;
+      if (valid) {
+        addLine(line);
+      } else if (!isValidUtf8(line)) {
+        if (!line.empty())
+          reject();
+      } else {
+        std::string normalized;
+        normalizeText(line, normalized, normalize);
+        addLine(normalized);
+      }
+    }
+  };
+
+  std::string chunk;
+  std::size_t carry = 0;
+  while (true) {
+    chunk.resize(carry + READ_CHUNK);
+    file.read(&chunk[carry], static_cast<std::streamsize>(READ_CHUNK));
+    std::size_t got = static_cast<std::size_t>(file.gcount());
+    chunk.resize(carry + got);
+
+    if (got < READ_CHUNK) {
+      if (!chunk.empty() && chunk.back() == '\n')
+        chunk.pop_back();
+      if (carry + got > 0)
+        addLines(chunk);
+      break;
+    }
+
+    std::size_t cut = chunk.rfind('\n');
+    if (cut == std::string::npos) {
+      // Строка длиннее блока: дочитывается со следующим.
+      carry = chunk.size();
+      continue;
+    }
+    addLines(std::string_view(chunk.data(), cut));
+    chunk.erase(0, cut + 1);
+    carry = chunk.size();
+  }
+
+  insertBuckets(buckets, threads);
+  return stats;
+}
+
+template void BasicTrie<LatinAlphabet>::bulkInsert(const std::vector<WordEntry> &, unsigned);
+template WordListStats
+BasicTrie<LatinAlphabet>::loadWordList(const std::string &, unsigned, const NormalizeOptions &);
+template void BasicTrie<RussianAlphabet>::bulkInsert(const std::vector<WordEntry> &, unsigned);
+template WordListStats
+BasicTrie<RussianAlphabet>::loadWordList(const std::string &, unsigned, const NormalizeOptions &);
+template void BasicTrie<MixedAlphabet>::bulkInsert(const std::vector<WordEntry> &, unsigned);
+template WordListStats
+BasicTrie<MixedAlphabet>::loadWordList(const std::string &, unsigned, const NormalizeOptions &);
+template void BasicTrie<UkrainianAlphabet>::bulkInsert(const std::vector<WordEntry> &, unsigned);
+template WordListStats
+BasicTrie<UkrainianAlphabet>::loadWordList(const std::string &, unsigned, const NormalizeOptions &);
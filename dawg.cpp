@@ -0,0 +1,278 @@
+/**
+ * @file dawg.cpp
+ * @brief Построение минимального автомата слов и поиск по нему.
+ */
+
+#include "dawg.h"
+#include "my_exception.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <unordered_set>
+
+namespace {
+
+/**
+ * @brief Переводит слово в последовательность индексов алфавита.
+ * @param word Слово UTF-8.
+ * @param chars Результат.
+ * @return false, если в слове есть символ вне алфавита.
+ */
+bool decodeWord(std::string_view word, std::vector<std::uint8_t> &chars) {
+  chars.clear();
+  for (std::size_t position = 0; position < word.size();) {
+    int index = DefaultAlphabet::nextIndex(word, position);
+    if (index == -1)
+      return false;
+    chars.push_back(static_cast<std::uint8_t>(index));
+  }
+  return true;
+}
+
+/**
+ * @struct StateHash
+ * @brief Хеш состояния по его правому языку: признак конца и переходы.
+ */
+struct StateHash {
+  const BasicNodeArena<DawgNode> *arena; ///< Арена состояний
+
+  std::size_t operator()(NodeId id) const {
+    const DawgNode &n = arena->node(id);
+    std::size_t h = n.childMask * 0x9E3779B97F4A7C15ull + n.isEndOfWord;
+    for (int i = 0; i < n.childCount(); ++i)
+      h = (h ^ arena->childAt(id, i)) * 0x100000001B3ull;
+    return h;
+  }
+};
+
+/**
+ * @struct StateEqual
+ * @brief Равенство состояний: одинаковые признак конца и переходы.
+ */
+struct StateEqual {
+  const BasicNodeArena<DawgNode> *arena; ///< Арена состояний
+
+  bool operator()(NodeId a, NodeId b) const {
+    const DawgNode &x = arena->node(a);
+    const DawgNode &y = arena->node(b);
+    if (x.isEndOfWord != y.isEndOfWord || x.childMask != y.childMask)
+      return false;
+    for (int i = 0; i < x.childCount(); ++i)
+      if (arena->childAt(a, i) != arena->childAt(b, i))
+        return false;
+    return true;
+  }
+};
+
+} // namespace
+
+// === Построение ===
+
+/**
+ * @brief Строит автомат по отсортированному списку слов.
+ *
+ * @details Путь последнего слова остаётся «открытым». Когда приходит
+ * следующее слово, часть пути глубже общего префикса больше не меняется:
+ * её состояния снизу вверх ищутся в реестре, и найденный эквивалент
+ * заменяет состояние у родителя, а само состояние освобождается.
+ * Состояния в реестре неизменяемы, поэтому число допускаемых слов
+ * считается один раз при регистрации.
+ *
+ * @param words Отсортированный список слов.
+ * @return Число слов в словаре.
+ * @throws UnsortedWordsException если порядок слов нарушен.
+ */
+std::size_t Dawg::build(const std::vector<std::string> &words) {
+  arena.clear();
+  root = arena.allocNode();
+
+  std::unordered_set<NodeId, StateHash, StateEqual> registry(
+      words.size(), StateHash{&arena}, StateEqual{&arena});
+  std::vector<NodeId> path{root};
+  std::vector<std::uint8_t> previous;
+  std::vector<std::uint8_t> chars;
+
+  auto minimize = [&](std::size_t depth) {
+    while (path.size() - 1 > depth) {
+      NodeId state = path.back();
+      path.pop_back();
+
+      DawgNode &n = arena.node(state);
+      n.words = n.isEndOfWord;
+      for (int i = 0; i < n.childCount(); ++i)
+        n.words += arena.node(arena.childAt(state, i)).words;
+
+      auto found = registry.find(state);
+      if (found != registry.end()) {
+        arena.setChild(path.back(), previous[path.size() - 1], *found);
+        arena.freeNode(state);
+      } else {
+        registry.insert(state);
+      }
+    }
+  };
+
+  for (const auto &word : words) {
+    if (!decodeWord(word, chars) || chars.empty())
+      continue;
+
+    std::size_t common = 0;
+    while (common < chars.size() && common < previous.size() &&
+           chars[common] == previous[common])
+      ++common;
+
+    if (common == chars.size()) {
+      if (common == previous.size())
+        continue;
+      throw UnsortedWordsException(word);
+    }
+    if (common < previous.size() && chars[common] < previous[common])
+      throw UnsortedWordsException(word);
+
+    minimize(common);
+    for (std::size_t i = common; i < chars.size(); ++i) {
+      NodeId state = arena.allocNode();
+      arena.addChild(path.back(), chars[i], state);
+      path.push_back(state);
+    }
+    arena.node(path.back()).isEndOfWord = true;
+    previous.swap(chars);
+  }
+  minimize(0);
+
+  DawgNode &start = arena.node(root);
+  start.words = start.isEndOfWord;
+  for (int i = 0; i < start.childCount(); ++i)
+    start.words += arena.node(arena.childAt(root, i)).words;
+
+  return size();
+}
+
+/**
+ * @brief Строит автомат по файлу со списком слов.
+ * @details Слова сортируются в порядке алфавита перед построением.
+ * @param path Путь к файлу.
+ * @return Число слов в словаре.
+ * @throws WordListException если файл не удалось открыть.
+ */
+std::size_t Dawg::loadWordList(const std::string &path) {
+  std::ifstream file(path);
+  if (!file)
+    throw WordListException(path, "не удалось открыть файл");
+
+  std::vector<std::pair<std::vector<std::uint8_t>, std::string>> keyed;
+  std::vector<std::uint8_t> chars;
+  std::string line;
+  while (std::getline(file, line)) {
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+
+    std::string word = line.substr(0, line.find_first_of(" \t"));
+    if (!word.empty() && decodeWord(word, chars))
+      keyed.emplace_back(chars, std::move(word));
+  }
+
+  std::sort(keyed.begin(), keyed.end());
+  std::vector<std::string> words;
+  words.reserve(keyed.size());
+  for (auto &entry : keyed)
+    words.push_back(std::move(entry.second));
+
+  return build(words);
+}
+
+// === Utilities ===
+
+/**
+ * @brief Спускается от начального состояния по префиксу.
+ * @param key Префикс.
+ * @return Состояние после префикса или NO_NODE.
+ */
+NodeId Dawg::walkPrefix(std::string_view key) const {
+  NodeId node = root;
+  for (std::size_t position = 0; position < key.size();) {
+    int index = DefaultAlphabet::nextIndex(key, position);
+    if (index == -1)
+      return NO_NODE;
+    node = arena.getChild(node, index);
+    if (node == NO_NODE)
+      return NO_NODE;
+  }
+  return node;
+}
+
+/**
+ * @brief Печатает число состояний, слов и занимаемую автоматом память.
+ */
+void Dawg::printMemoryUsage() const {
+  std::size_t words = size();
+  std::size_t bytes = arena.memoryUsage();
+
+  std::cout << "Состояний: " << arena.liveNodes() << ", слов: " << words
+            << ", память: " << bytes << " байт";
+  if (words)
+    std::cout << " (" << bytes / words << " байт на слово)";
+  std::cout << std::endl;
+}
+
+// === Find ===
+
+/**
+ * @brief Рекурсивно собирает слова, допускаемые из состояния.
+ * @param node Текущее состояние.
+ * @param outString Буфер собранной строки (восстанавливается после вызова).
+ * @param results Вектор результатов.
+ */
+void Dawg::collectWords(NodeId node, std::string &outString,
+                        std::vector<std::string> &results) const {
+  const DawgNode &n = arena.node(node);
+  if (n.isEndOfWord)
+    results.push_back(outString);
+
+  std::size_t len = outString.size();
+  int slot = 0;
+  for (std::uint64_t mask = n.childMask; mask; mask &= mask - 1, ++slot) {
+    outString += DefaultAlphabet::symbol(lowestBit64(mask));
+    collectWords(arena.childAt(node, slot), outString, results);
+    outString.resize(len);
+  }
+}
+
+/**
+ * @brief Проверяет наличие слова в словаре.
+ * @param key Слово для поиска.
+ * @return true, если слово найдено.
+ */
+bool Dawg::findOneByKey(std::string_view key) const {
+  if (key.empty())
+    return false;
+  NodeId node = walkPrefix(key);
+  return node != NO_NODE && arena.node(node).isEndOfWord;
+}
+
+/**
+ * @brief Находит все слова, начинающиеся с заданного префикса.
+ * @details Число результатов известно заранее из счётчика состояния.
+ * @param key Префикс.
+ * @param results Вектор, куда помещаются найденные слова.
+ */
+void Dawg::findAllByKey(std::string_view key, std::vector<std::string> &results) const {
+  results.clear();
+  NodeId node = walkPrefix(key);
+  if (node == NO_NODE)
+    return;
+
+  results.reserve(arena.node(node).words);
+  std::string outString(key);
+  collectWords(node, outString, results);
+}
+
+/**
+ * @brief Считает слова с заданным префиксом.
+ * @param key Префикс.
+ * @return Количество слов.
+ */
+std::size_t Dawg::countByKey(std::string_view key) const {
+  NodeId node = walkPrefix(key);
+  return node == NO_NODE ? 0 : arena.node(node).words;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file dawg.h
+ * @brief Минимальный ациклический автомат слов (DAWG) для неизменяемых словарей.
+ */
+
+#pragma once
+
+#include "alphabet.h"
+#include "node_arena.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @struct DawgNode
+ * @brief Состояние автомата.
+ *
+ * @details Переходы хранятся, как в TrieNode: битовая маска символов и
+ * плотный блок ссылок в арене. В отличие от узла дерева, на состояние
+ * может ссылаться несколько родителей (общие окончания слов), поэтому
+ * веса слов в автомате не хранятся.
+ */
+struct DawgNode {
+  std::uint64_t childMask; ///< Маска переходов (бит = индекс символа)
+  NodeId children;         ///< Смещение блока переходов в пуле ссылок
+  std::uint32_t words;     ///< Число слов, допускаемых из состояния
+  bool isEndOfWord;        ///< Признак конечного состояния
+
+  /**
+   * @brief Конструктор по умолчанию.
+   */
+  DawgNode() : childMask(0), children(NO_NODE), words(0), isEndOfWord(false) {}
+
+  /**
+   * @brief Количество переходов.
+   * @return Число установленных бит маски
+   */
+  int childCount() const { return popcount64(childMask); }
+
+  /**
+   * @brief Позиция перехода по символу в плотном блоке.
+   * @param index Индекс символа в алфавите
+   * @return Смещение внутри блока
+   */
+  int slotOf(int index) const {
+    return popcount64(childMask & ((std::uint64_t(1) << index) - 1));
+  }
+
+  /**
+   * @brief Проверяет наличие перехода по символу.
+   * @param index Индекс символа в алфавите
+   * @return true, если переход есть
+   */
+  bool hasChild(int index) const { return childMask & (std::uint64_t(1) << index); }
+};
+
+/**
+ * @class Dawg
+ * @brief Словарь только для чтения в виде минимального автомата.
+ *
+ * @details Строится за один проход по отсортированному списку слов с
+ * инкрементальной минимизацией: как только ветка предыдущего слова больше
+ * не может измениться, её состояния сверяются с реестром уже построенных
+ * и заменяются эквивалентными. Общие окончания (-ать, -ить, -ость)
+ * хранятся один раз. Каждое состояние знает число слов, достижимых из
+ * него, поэтому количество слов с префиксом считается за длину префикса.
+ */
+class Dawg {
+private:
+  BasicNodeArena<DawgNode> arena; ///< Арена состояний
+  NodeId root;                    ///< Начальное состояние
+
+  /**
+   * @brief Спускается от начального состояния по префиксу.
+   * @param key Префикс
+   * @return Состояние после префикса или NO_NODE
+   */
+  NodeId walkPrefix(std::string_view key) const;
+
+  /**
+   * @brief Рекурсивно собирает слова, допускаемые из состояния.
+   * @param node Текущее состояние
+   * @param outString Буфер собранного слова (восстанавливается после вызова)
+   * @param results Список результатов
+   */
+  void collectWords(NodeId node, std::string &outString,
+                    std::vector<std::string> &results) const;
+
+public:
+  /**
+   * @brief Конструктор. Создаёт пустой словарь.
+   */
+  Dawg() { root = arena.allocNode(); }
+
+  Dawg(const Dawg &) = delete;
+  Dawg &operator=(const Dawg &) = delete;
+
+  // === Построение ===
+
+  /**
+   * @brief Строит автомат по списку слов, заменяя прежнее содержимое.
+   * @details Слова должны идти в порядке алфавита сборки (не байтовом:
+   * «ё» стоит между «е» и «ж»). Повторы пропускаются, слова с символами
+   * вне алфавита — тоже.
+   * @param words Отсортированный список слов
+   * @return Число слов в словаре
+   * @throws UnsortedWordsException если порядок слов нарушен
+   */
+  std::size_t build(const std::vector<std::string> &words);
+
+  /**
+   * @brief Строит автомат по файлу со списком слов.
+   * @details Формат файла тот же, что у Trie::loadWordList; частоты
+   * игнорируются. Файл не обязан быть отсортирован.
+   * @param path Путь к файлу
+   * @return Число слов в словаре
+   * @throws WordListException если файл не удалось открыть
+   */
+  std::size_t loadWordList(const std::string &path);
+
+  // === Getters ===
+
+  /**
+   * @brief Возвращает начальное состояние.
+   * @return Индекс состояния в арене
+   */
+  NodeId getRoot() const { return root; }
+
+  /**
+   * @brief Число слов в словаре.
+   * @return Количество слов
+   */
+  std::size_t size() const { return arena.node(root).words; }
+
+  // === Utilities ===
+
+  /**
+   * @brief Печатает число состояний, слов и занимаемую автоматом память.
+   */
+  void printMemoryUsage() const;
+
+  // === Searching ===
+
+  /**
+   * @brief Проверяет, есть ли слово в словаре.
+   * @param key Искомое слово
+   * @return true, если слово найдено
+   */
+  bool findOneByKey(std::string_view key) const;
+
+  /**
+   * @brief Находит все слова, начинающиеся с указанного префикса.
+   * @param key Префикс
+   * @param results Вектор найденных слов (в порядке алфавита)
+   */
+  void findAllByKey(std::string_view key, std::vector<std::string> &results) const;
+
+  /**
+   * @brief Считает слова с указанным префиксом без их перебора.
+   * @param key Префикс
+   * @return Количество слов
+   */
+  std::size_t countByKey(std::string_view key) const;
+};
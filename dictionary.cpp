@@ -0,0 +1,52 @@
+/**
+ * @file dictionary.cpp
+ * @brief Выбор реализации словаря только для чтения.
+ */
+
+#include "dictionary.h"
+#include "double_array.h"
+#include "louds_trie.h"
+#include "prefix_tree.h"
+
+/**
+ * @brief Разбирает имя реализации.
+ * @param name Имя из командной строки ("trie", "double-array" или "louds").
+ * @param backend Результат.
+ * @return false, если имя неизвестно.
+ */
+bool parseDictionaryBackend(std::string_view name, DictionaryBackend &backend) {
+  if (name == "trie")
+    backend = DictionaryBackend::Trie;
+  else if (name == "double-array")
+    backend = DictionaryBackend::DoubleArray;
+  else if (name == "louds")
+    backend = DictionaryBackend::Louds;
+  else
+    return false;
+  return true;
+}
+
+/**
+ * @brief Загружает список слов в словарь выбранной реализации.
+ * @param path Путь к файлу.
+ * @param backend Реализация.
+ * @param threads Число потоков построения дерева.
+ * @param normalize Параметры нормализации.
+ * @param stats Итог загрузки (если не nullptr).
+ * @return Готовый словарь.
+ * @throws WordListException если файл не удалось открыть.
+ */
+std::unique_ptr<Dictionary> loadDictionary(const std::string &path, DictionaryBackend backend,
+                                           unsigned threads, const NormalizeOptions &normalize,
+                                           WordListStats *stats) {
+  std::unique_ptr<Trie> trie(new Trie());
+  WordListStats loaded = trie->loadWordList(path, threads, normalize);
+  if (stats)
+    *stats = loaded;
+
+  if (backend == DictionaryBackend::DoubleArray)
+    return std::unique_ptr<Dictionary>(new DoubleArrayTrie(*trie));
+  if (backend == DictionaryBackend::Louds)
+    return std::unique_ptr<Dictionary>(new LoudsTrie(*trie));
+  return trie;
+}
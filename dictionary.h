@@ -0,0 +1,75 @@
+/**
+ * @file dictionary.h
+ * @brief Общий интерфейс словарей только для чтения и выбор реализации.
+ */
+
+#pragma once
+
+#include "utf8_text.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct WordListStats;
+
+/**
+ * @class Dictionary
+ * @brief Словарь, отвечающий на точный и префиксный запросы.
+ *
+ * @details Реализации обязаны выдавать одинаковые ответы: findAllByKey
+ * возвращает слова в порядке алфавита сборки.
+ */
+class Dictionary {
+public:
+  virtual ~Dictionary() = default;
+
+  /**
+   * @brief Проверяет, есть ли слово в словаре.
+   * @param key Искомое слово
+   * @return true, если слово найдено
+   */
+  virtual bool findOneByKey(std::string_view key) const = 0;
+
+  /**
+   * @brief Находит все слова, начинающиеся с указанного префикса.
+   * @param key Префикс
+   * @param results Вектор найденных слов
+   */
+  virtual void findAllByKey(std::string_view key, std::vector<std::string> &results) const = 0;
+};
+
+/**
+ * @enum DictionaryBackend
+ * @brief Реализация словаря, выбираемая при создании.
+ */
+enum class DictionaryBackend {
+  Trie,       ///< Изменяемое дерево Trie
+  DoubleArray, ///< Статический двойной массив (BASE/CHECK)
+  Louds        ///< Сжатое дерево LOUDS
+};
+
+/**
+ * @brief Разбирает имя реализации ("trie", "double-array" или "louds").
+ * @param name Имя из командной строки
+ * @param backend Результат
+ * @return false, если имя неизвестно
+ */
+bool parseDictionaryBackend(std::string_view name, DictionaryBackend &backend);
+
+/**
+ * @brief Загружает список слов в словарь выбранной реализации.
+ * @details Статические реализации строятся по промежуточному дереву,
+ * которое освобождается после построения.
+ * @param path Путь к файлу (формат как у Trie::loadWordList)
+ * @param backend Реализация
+ * @param threads Число потоков построения дерева (0 — по числу ядер)
+ * @param normalize Параметры нормализации
+ * @param stats Итог загрузки (если не nullptr)
+ * @return Готовый словарь
+ * @throws WordListException если файл не удалось открыть
+ */
+std::unique_ptr<Dictionary> loadDictionary(const std::string &path, DictionaryBackend backend,
+                                           unsigned threads = 0,
+                                           const NormalizeOptions &normalize = {},
+                                           WordListStats *stats = nullptr);
@@ -0,0 +1,186 @@
+/**
+ * @file dictionary_store.cpp
+ * @brief Реализация сохранения изменений словаря.
+ */
+
+#include "dictionary_store.h"
+#include "my_exception.h"
+#include "trie_snapshot.h"
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Конструктор.
+ * @param trie Дерево.
+ * @param snapshotPath Путь к снимку.
+ * @param options Параметры.
+ */
+DictionaryStore::DictionaryStore(Trie &trie, std::string snapshotPath, StoreOptions options)
+    : dictionary(trie), snapshotPath(std::move(snapshotPath)), options(options) {}
+
+/**
+ * @brief Деструктор. Дожидается записи снимка и сбрасывает журнал.
+ */
+DictionaryStore::~DictionaryStore() { close(); }
+
+/**
+ * @brief Воспроизводит журнал и открывает его для дозаписи.
+ * @return Число применённых записей, отброшенных байт и время.
+ * @throws JournalException если журнал не читается или не открывается.
+ */
+RecoveryStats DictionaryStore::recover() {
+  RecoveryStats stats;
+  if (snapshotPath.empty())
+    return stats;
+
+  auto start = std::chrono::steady_clock::now();
+  std::unique_ptr<Journal> opened(
+      new Journal(journalPath(), DefaultAlphabet::FINGERPRINT, options.commitWindow));
+  for (const std::string &path : {opened->oldPath(), journalPath()}) {
+    JournalReplay replay = replayJournal(path, DefaultAlphabet::FINGERPRINT, dictionary);
+    stats.records += replay.records;
+    stats.discardedBytes += replay.discardedBytes;
+  }
+  opened->open();
+  journal = std::move(opened);
+  stats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+                 .count();
+  return stats;
+}
+
+/**
+ * @brief Вставляет слово и записывает изменение в журнал.
+ * @param word Нормализованное слово.
+ * @param weight Вес.
+ * @return false, если слово не принято деревом.
+ */
+bool DictionaryStore::insert(std::string_view word, std::uint32_t weight) {
+  if (word.size() > JOURNAL_MAX_WORD || !dictionary.insert(word, weight))
+    return false;
+  if (journal) {
+    journal->append(JournalOp::Add, word, weight);
+    maybeCompact();
+  }
+  return true;
+}
+
+/**
+ * @brief Удаляет слово и записывает изменение в журнал.
+ * @param word Нормализованное слово.
+ * @return false, если слова нет в словаре.
+ * @throws JournalException если удаление нельзя записать в журнал (слово
+ * длиннее JOURNAL_MAX_WORD); дерево при этом не меняется.
+ */
+bool DictionaryStore::remove(std::string_view word) {
+  // Такое слово могло прийти из списка слов или снимка, минуя insert.
+  if (journal && word.size() > JOURNAL_MAX_WORD)
+    throw JournalException(journalPath(), "слово длиннее " + std::to_string(JOURNAL_MAX_WORD) +
+                                              " байт");
+  if (word.empty() || !dictionary.delWord(dictionary.getRoot(), word, 0))
+    return false;
+  if (journal) {
+    journal->append(JournalOp::Delete, word);
+    maybeCompact();
+  }
+  return true;
+}
+
+/**
+ * @brief Ждёт, пока все изменения окажутся на диске.
+ * @throws JournalException если журнал не удалось записать.
+ * @throws SnapshotException если не удалась фоновая запись снимка.
+ */
+void DictionaryStore::sync() {
+  if (journal)
+    journal->sync();
+
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> lock(failureMutex);
+    std::swap(error, failure);
+  }
+  if (error)
+    std::rethrow_exception(error);
+}
+
+/**
+ * @brief Записывает снимок сразу и очищает журнал.
+ * @throws SnapshotException если снимок не удалось записать.
+ * @throws JournalException если журнал не удалось очистить.
+ */
+void DictionaryStore::checkpoint() {
+  if (compactor.joinable())
+    compactor.join();
+  compactTree();
+  dictionary.save(snapshotPath);
+  if (journal)
+    journal->reset();
+}
+
+/**
+ * @brief Уплотняет дерево, если свободных узлов не меньше четверти живых.
+ */
+void DictionaryStore::compactTree() {
+  ArenaUsage usage = dictionary.nodeUsage();
+  if (usage.deadNodes * 4 >= usage.liveNodes && usage.deadNodes)
+    dictionary.compact();
+}
+
+/**
+ * @brief Запускает запись снимка, если журнал вырос.
+ */
+void DictionaryStore::maybeCompact() {
+  if (!compacting && journal->size() >= options.compactBytes)
+    compact();
+}
+
+/**
+ * @brief Запускает запись снимка в фоне.
+ *
+ * @details Образ дерева собирается здесь же, копированием арены: после
+ * этого дерево можно менять, а поток записи работает только с копией.
+ * Если удаления оставили в арене много свободных слотов, дерево перед
+ * этим уплотняется, и снимок получается без дыр.
+ * Записи журнала переносятся в старый сегмент до запуска потока, и новые
+ * изменения идут уже в пустой текущий.
+ *
+ * @return false, если журнала нет или запись уже идёт.
+ * @throws JournalException если записи журнала не удалось перенести.
+ */
+bool DictionaryStore::compact() {
+  if (!journal || compacting)
+    return false;
+  if (compactor.joinable())
+    compactor.join();
+
+  compactTree();
+  std::vector<char> image;
+  dictionary.saveImage(image);
+  journal->rotate();
+
+  compacting = true;
+  ++compactions;
+  compactor = std::thread([this, image = std::move(image)]() {
+    try {
+      writeFileAtomically(snapshotPath, {{image.data(), image.size()}});
+      journal->dropOld();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(failureMutex);
+      failure = std::current_exception();
+    }
+    compacting = false;
+  });
+  return true;
+}
+
+/**
+ * @brief Дожидается записи снимка и закрывает журнал.
+ */
+void DictionaryStore::close() {
+  if (compactor.joinable())
+    compactor.join();
+  if (journal) {
+    journal->close();
+    journal.reset();
+  }
+}
@@ -0,0 +1,172 @@
+/**
+ * @file dictionary_store.h
+ * @brief Сохранение изменений словаря: снимок плюс журнал.
+ */
+
+#pragma once
+
+#include "journal.h"
+#include "prefix_tree.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+/**
+ * @struct StoreOptions
+ * @brief Параметры сохранения изменений.
+ */
+struct StoreOptions {
+  std::chrono::milliseconds commitWindow{2}; ///< Окно группировки fsync журнала
+  std::uint64_t compactBytes = 4u << 20;     ///< Размер журнала, после которого пишется снимок
+};
+
+/**
+ * @struct RecoveryStats
+ * @brief Итог восстановления изменений из журнала.
+ */
+struct RecoveryStats {
+  std::size_t records = 0;          ///< Применено записей журнала
+  std::uint64_t discardedBytes = 0; ///< Отброшено байт повреждённого хвоста
+  double ms = 0;                    ///< Время воспроизведения
+};
+
+/**
+ * @class DictionaryStore
+ * @brief Точка изменения словаря, переживающая перезапуск процесса.
+ *
+ * @details Каждое изменение применяется к дереву и дописывается в журнал
+ * рядом со снимком (путь снимка + ".journal"). При старте снимок
+ * отображается в память, а журнал воспроизводится поверх него, так что
+ * время восстановления зависит от длины журнала, а не от размера словаря.
+ * Когда журнал вырастает до StoreOptions::compactBytes, образ дерева
+ * копируется в память, записи журнала уходят в старый сегмент, и в
+ * фоновом потоке пишется новый снимок, после чего старый сегмент
+ * удаляется. Сбой на любом шаге оставляет снимок и сегменты, из которых
+ * состояние восстанавливается полностью.
+ *
+ * Перед записью снимка дерево может быть уплотнено (Trie::compact), поэтому
+ * курсоры и сессии ввода не должны переживать вызовы insert, remove,
+ * checkpoint и compact.
+ *
+ * Без пути снимка изменения только применяются к дереву.
+ */
+class DictionaryStore {
+private:
+  Trie &dictionary;                 ///< Дерево
+  std::string snapshotPath;         ///< Путь к снимку ("" — без сохранения)
+  StoreOptions options;             ///< Параметры
+  std::unique_ptr<Journal> journal; ///< Открытый журнал (после recover)
+
+  std::thread compactor;                ///< Поток записи снимка
+  std::atomic<bool> compacting{false};  ///< Запись снимка идёт
+  std::mutex failureMutex;              ///< Защищает failure
+  std::exception_ptr failure;           ///< Ошибка фоновой записи снимка
+  std::size_t compactions = 0;          ///< Запущено фоновых записей снимка
+
+  /**
+   * @brief Запускает запись снимка, если журнал вырос.
+   */
+  void maybeCompact();
+
+  /**
+   * @brief Уплотняет дерево (Trie::compact), если удаления оставили много
+   * свободных узлов.
+   */
+  void compactTree();
+
+public:
+  /**
+   * @brief Конструктор.
+   * @param trie Дерево
+   * @param snapshotPath Путь к снимку ("" — изменения не сохраняются)
+   * @param options Параметры
+   */
+  explicit DictionaryStore(Trie &trie, std::string snapshotPath = "", StoreOptions options = {});
+
+  /**
+   * @brief Деструктор. Дожидается записи снимка и сбрасывает журнал.
+   */
+  ~DictionaryStore();
+
+  DictionaryStore(const DictionaryStore &) = delete;
+  DictionaryStore &operator=(const DictionaryStore &) = delete;
+
+  /**
+   * @brief Дерево словаря.
+   * @return Ссылка на дерево
+   */
+  Trie &trie() { return dictionary; }
+
+  /**
+   * @brief Путь к журналу.
+   * @return Путь снимка + ".journal"
+   */
+  std::string journalPath() const { return snapshotPath + ".journal"; }
+
+  /**
+   * @brief Воспроизводит журнал поверх загруженного дерева и открывает его
+   * для дозаписи.
+   * @details Сначала применяется старый сегмент (если прошлая запись
+   * снимка не завершилась), затем текущий.
+   * @return Число применённых записей, отброшенных байт и время
+   * @throws JournalException если журнал не читается или не открывается
+   */
+  RecoveryStats recover();
+
+  /**
+   * @brief Вставляет слово и записывает изменение в журнал.
+   * @param word Нормализованное слово
+   * @param weight Вес
+   * @return false, если слово не принято деревом или длиннее JOURNAL_MAX_WORD
+   */
+  bool insert(std::string_view word, std::uint32_t weight = 1);
+
+  /**
+   * @brief Удаляет слово и записывает изменение в журнал.
+   * @param word Нормализованное слово
+   * @return false, если слова нет в словаре
+   * @throws JournalException если слово длиннее JOURNAL_MAX_WORD (дерево не
+   * меняется)
+   */
+  bool remove(std::string_view word);
+
+  /**
+   * @brief Ждёт, пока все изменения окажутся на диске.
+   * @throws JournalException если журнал не удалось записать
+   * @throws SnapshotException если не удалась фоновая запись снимка
+   */
+  void sync();
+
+  /**
+   * @brief Записывает снимок сразу и очищает журнал.
+   * @details Используется, когда словарь построен заново, а не загружен
+   * из снимка.
+   * @throws SnapshotException если снимок не удалось записать
+   * @throws JournalException если журнал не удалось очистить
+   */
+  void checkpoint();
+
+  /**
+   * @brief Запускает запись снимка в фоне.
+   * @return false, если журнала нет или запись уже идёт
+   * @throws JournalException если записи журнала не удалось перенести
+   */
+  bool compact();
+
+  /**
+   * @brief Дожидается записи снимка и закрывает журнал.
+   */
+  void close();
+
+  /**
+   * @brief Число запущенных фоновых записей снимка.
+   * @return Количество
+   */
+  std::size_t compactionCount() const { return compactions; }
+};
@@ -0,0 +1,255 @@
+/**
+ * @file double_array.cpp
+ * @brief Построение двойного массива по дереву Trie и поиск по нему.
+ */
+
+#include "double_array.h"
+#include "alphabet.h"
+#include "prefix_tree.h"
+#include <algorithm>
+#include <iostream>
+
+// === Построение ===
+
+/**
+ * @brief Строит двойной массив по готовому дереву.
+ * @param source Исходное дерево.
+ */
+DoubleArrayTrie::DoubleArrayTrie(const Trie &source) : words(0) {
+  build(source);
+}
+
+/**
+ * @brief Строит двойной массив по файлу со списком слов.
+ * @details Слова сначала загружаются в промежуточное дерево, которое
+ * освобождается после раскладки.
+ * @param path Путь к файлу.
+ * @param threads Число потоков построения промежуточного дерева.
+ * @throws WordListException если файл не удалось открыть.
+ */
+DoubleArrayTrie::DoubleArrayTrie(const std::string &path, unsigned threads) : words(0) {
+  Trie source;
+  source.loadWordList(path, threads);
+  build(source);
+}
+
+/**
+ * @brief Раскладывает дерево по ячейкам.
+ *
+ * @details Узлы обходятся в ширину. Для каждого узла подбирается BASE,
+ * при котором все ячейки его потомков свободны. Кандидаты на ячейку
+ * первого потомка берутся из двусвязного списка свободных ячеек, так что
+ * занятые ячейки не просматриваются. Ячейка, на которую много раз не
+ * удалось поставить узел с несколькими потомками, исключается из поиска
+ * (сама она остаётся свободной и может достаться потомку другого узла):
+ * иначе каждый широкий узел заново перебирал бы одни и те же «дыры».
+ *
+ * @param source Исходное дерево.
+ */
+void DoubleArrayTrie::build(const Trie &source) {
+  /// Сколько неудачных попыток выдерживает ячейка до исключения из поиска.
+  const std::uint8_t MAX_REJECTS = 8;
+  /// Отметка ячейки, которой нет в списке свободных.
+  const std::uint8_t UNLISTED = 0xFF;
+
+  const Trie::Arena &arena = source.arena;
+  cells.assign(1, Cell{0, 0});
+  masks.assign(1, 0);
+  words = 0;
+
+  std::vector<std::int32_t> nextFree(1, -1);
+  std::vector<std::int32_t> prevFree(1, -1);
+  std::vector<std::uint8_t> rejects(1, UNLISTED);
+  std::int32_t freeHead = -1;
+  std::int32_t freeTail = -1;
+
+  auto grow = [&](std::size_t size) {
+    std::size_t old = cells.size();
+    if (size <= old)
+      return;
+    size = std::max(size, old + old / 2);
+    cells.resize(size, Cell{0, -1});
+    masks.resize(size, 0);
+    nextFree.resize(size, -1);
+    prevFree.resize(size, -1);
+    rejects.resize(size, 0);
+    for (std::size_t i = old; i < size; ++i) {
+      std::int32_t cell = static_cast<std::int32_t>(i);
+      prevFree[cell] = freeTail;
+      if (freeTail >= 0)
+        nextFree[freeTail] = cell;
+      else
+        freeHead = cell;
+      freeTail = cell;
+    }
+  };
+
+  auto unlist = [&](std::int32_t cell) {
+    if (rejects[cell] == UNLISTED)
+      return;
+    rejects[cell] = UNLISTED;
+    if (prevFree[cell] >= 0)
+      nextFree[prevFree[cell]] = nextFree[cell];
+    else
+      freeHead = nextFree[cell];
+    if (nextFree[cell] >= 0)
+      prevFree[nextFree[cell]] = prevFree[cell];
+    else
+      freeTail = prevFree[cell];
+  };
+
+  std::vector<std::pair<NodeId, std::int32_t>> queue{{source.root, 0}};
+  for (std::size_t head = 0; head < queue.size(); ++head) {
+    NodeId node = queue[head].first;
+    std::int32_t state = queue[head].second;
+    const Trie::Node &n = arena.node(node);
+
+    masks[state] = n.childMask | (n.isEndOfWord ? END_OF_WORD : 0);
+    words += n.isEndOfWord;
+    if (!n.childMask)
+      continue;
+
+    int firstCode = lowestBit64(n.childMask) + 1;
+    std::uint64_t others = n.childMask & (n.childMask - 1);
+    std::int32_t base = 0;
+    for (std::int32_t cell = freeHead;;) {
+      if (cell < 0) {
+        std::size_t old = cells.size();
+        grow(old + DefaultAlphabet::SIZE + 1);
+        cell = static_cast<std::int32_t>(old);
+      }
+      std::int32_t next = nextFree[cell];
+      if (cell <= firstCode) {
+        cell = next;
+        continue;
+      }
+
+      base = cell - firstCode;
+      grow(static_cast<std::size_t>(base) + DefaultAlphabet::SIZE + 1);
+      next = nextFree[cell];
+
+      bool fits = true;
+      for (std::uint64_t mask = others; mask && fits; mask &= mask - 1)
+        fits = cells[base + lowestBit64(mask) + 1].check < 0;
+      if (fits)
+        break;
+
+      if (++rejects[cell] >= MAX_REJECTS)
+        unlist(cell);
+      cell = next;
+    }
+
+    cells[state].base = base;
+    int slot = 0;
+    for (std::uint64_t mask = n.childMask; mask; mask &= mask - 1, ++slot) {
+      std::int32_t target = base + lowestBit64(mask) + 1;
+      unlist(target);
+      cells[target].check = state;
+      queue.push_back({arena.childAt(node, slot), target});
+    }
+  }
+
+  std::size_t used = cells.size();
+  while (used > 1 && cells[used - 1].check < 0)
+    --used;
+  cells.resize(used);
+  masks.resize(used);
+  cells.shrink_to_fit();
+  masks.shrink_to_fit();
+}
+
+// === Utilities ===
+
+/**
+ * @brief Печатает число ячеек, их заполненность и занимаемую память.
+ */
+void DoubleArrayTrie::printMemoryUsage() const {
+  std::size_t used = 0;
+  for (const Cell &cell : cells)
+    used += cell.check >= 0;
+  std::size_t bytes = (cells.capacity() + masks.capacity()) * sizeof(Cell);
+
+  std::cout << "Ячеек: " << cells.size() << " (занято " << used << "), слов: " << words
+            << ", память: " << bytes << " байт";
+  if (words)
+    std::cout << " (" << bytes / words << " байт на слово)";
+  std::cout << std::endl;
+}
+
+/**
+ * @brief Спускается от начального состояния по префиксу.
+ * @param key Префикс.
+ * @return Состояние после префикса или -1.
+ */
+std::int32_t DoubleArrayTrie::walkPrefix(std::string_view key) const {
+  std::int32_t state = 0;
+  const std::size_t size = cells.size();
+
+  for (std::size_t position = 0; position < key.size();) {
+    int index = DefaultAlphabet::nextIndex(key, position);
+    if (index == -1)
+      return -1;
+
+    std::int32_t base = cells[state].base;
+    if (base == 0)
+      return -1;
+    std::size_t target = static_cast<std::size_t>(base) + index + 1;
+    if (target >= size || cells[target].check != state)
+      return -1;
+    state = static_cast<std::int32_t>(target);
+  }
+  return state;
+}
+
+// === Find ===
+
+/**
+ * @brief Рекурсивно собирает слова из состояния.
+ * @details Потомки перебираются по маске в порядке возрастания индекса
+ * символа, поэтому порядок слов совпадает с Trie::findAllByKey.
+ * @param state Текущее состояние.
+ * @param outString Буфер собранной строки (восстанавливается после вызова).
+ * @param results Вектор результатов.
+ */
+void DoubleArrayTrie::collectWords(std::int32_t state, std::string &outString,
+                                   std::vector<std::string> &results) const {
+  std::uint64_t mask = masks[state];
+  if (mask & END_OF_WORD)
+    results.push_back(outString);
+
+  std::int32_t base = cells[state].base;
+  std::size_t len = outString.size();
+  for (mask &= ~END_OF_WORD; mask; mask &= mask - 1) {
+    int index = lowestBit64(mask);
+    outString += DefaultAlphabet::symbol(index);
+    collectWords(base + index + 1, outString, results);
+    outString.resize(len);
+  }
+}
+
+/**
+ * @brief Проверяет наличие слова в словаре.
+ * @param key Слово для поиска.
+ * @return true, если слово найдено.
+ */
+bool DoubleArrayTrie::findOneByKey(std::string_view key) const {
+  if (key.empty())
+    return false;
+  std::int32_t state = walkPrefix(key);
+  return state >= 0 && (masks[state] & END_OF_WORD);
+}
+
+/**
+ * @brief Находит все слова, начинающиеся с заданного префикса.
+ * @param key Префикс.
+ * @param results Вектор, куда помещаются найденные слова.
+ */
+void DoubleArrayTrie::findAllByKey(std::string_view key, std::vector<std::string> &results) const {
+  results.clear();
+  std::int32_t state = walkPrefix(key);
+  if (state < 0)
+    return;
+
+  std::string outString(key);
+  collectWords(state, outString, results);
+}
@@ -0,0 +1,96 @@
+/**
+ * @file double_array.h
+ * @brief Статическое префиксное дерево в виде двойного массива (BASE/CHECK).
+ */
+
+#pragma once
+
+#include "dictionary.h"
+#include "prefix_tree.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/**
+ * @class DoubleArrayTrie
+ * @brief Неизменяемое дерево, переходы которого — два чтения из одного массива.
+ *
+ * @details Состояние s переходит по символу с индексом i в состояние
+ * t = BASE[s] + i + 1, если CHECK[t] == s. BASE и CHECK лежат рядом в
+ * одной ячейке, а потомки одного состояния — в соседних ячейках, поэтому
+ * поиск не прыгает по разбросанным в памяти узлам. Состояния
+ * раскладываются обходом в ширину, начальное состояние — ячейка 0.
+ */
+class DoubleArrayTrie final : public Dictionary {
+private:
+  /**
+   * @struct Cell
+   * @brief Ячейка двойного массива.
+   */
+  struct Cell {
+    std::int32_t base;  ///< Смещение блока потомков (0 — потомков нет)
+    std::int32_t check; ///< Родительское состояние (-1 — ячейка свободна)
+  };
+
+  /// Старший бит маски состояния — признак конца слова.
+  static constexpr std::uint64_t END_OF_WORD = std::uint64_t(1) << 63;
+  static_assert(DefaultAlphabet::SIZE < 64, "бит 63 маски занят признаком конца слова");
+
+  std::vector<Cell> cells;          ///< Ячейки BASE/CHECK
+  std::vector<std::uint64_t> masks; ///< Маски символов потомков и признак конца слова
+  std::size_t words;                ///< Число слов
+
+  /**
+   * @brief Раскладывает дерево по ячейкам.
+   * @param source Исходное дерево
+   */
+  void build(const Trie &source);
+
+  /**
+   * @brief Спускается от начального состояния по префиксу.
+   * @param key Префикс
+   * @return Состояние после префикса или -1
+   */
+  std::int32_t walkPrefix(std::string_view key) const;
+
+  /**
+   * @brief Рекурсивно собирает слова из состояния.
+   * @param state Текущее состояние
+   * @param outString Буфер собранного слова (восстанавливается после вызова)
+   * @param results Список результатов
+   */
+  void collectWords(std::int32_t state, std::string &outString,
+                    std::vector<std::string> &results) const;
+
+public:
+  /**
+   * @brief Строит двойной массив по готовому дереву.
+   * @param source Исходное дерево (не изменяется)
+   */
+  explicit DoubleArrayTrie(const Trie &source);
+
+  /**
+   * @brief Строит двойной массив по файлу со списком слов.
+   * @param path Путь к файлу (формат как у Trie::loadWordList)
+   * @param threads Число потоков построения промежуточного дерева
+   * @throws WordListException если файл не удалось открыть
+   */
+  explicit DoubleArrayTrie(const std::string &path, unsigned threads = 0);
+
+  /**
+   * @brief Число слов в словаре.
+   * @return Количество слов
+   */
+  std::size_t size() const { return words; }
+
+  /**
+   * @brief Печатает число ячеек, их заполненность и занимаемую память.
+   */
+  void printMemoryUsage() const;
+
+  bool findOneByKey(std::string_view key) const override;
+
+  void findAllByKey(std::string_view key, std::vector<std::string> &results) const override;
+};
@@ -0,0 +1,371 @@
+/**
+ * @file journal.cpp
+ * @brief Реализация журнала изменений словаря.
+ */
+
+#include "journal.h"
+#include "my_exception.h"
+#include "trie_snapshot.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+/**
+ * @brief Сбрасывает файл на диск.
+ * @param file Открытый файл.
+ * @return true при успехе.
+ */
+bool syncFile(std::FILE *file) {
+  if (std::fflush(file) != 0)
+    return false;
+#if defined(_WIN32)
+  return _commit(_fileno(file)) == 0;
+#else
+  return fsync(fileno(file)) == 0;
+#endif
+}
+
+/**
+ * @brief Контрольная сумма записи.
+ * @param record Заголовок записи (поле checksum не учитывается).
+ * @param word Слово.
+ * @return Значение контрольной суммы.
+ */
+std::uint32_t recordChecksum(const JournalRecord &record, std::string_view word) {
+  const char *fields = reinterpret_cast<const char *>(&record) + sizeof(record.checksum);
+  std::uint64_t hash = snapshotChecksum(fields, sizeof(record) - sizeof(record.checksum));
+  return static_cast<std::uint32_t>(snapshotChecksum(word.data(), word.size(), hash));
+}
+
+/**
+ * @brief Читает файл целиком.
+ * @param path Путь к файлу.
+ * @param data Содержимое.
+ * @return false, если файла нет или его не удалось прочитать.
+ */
+bool readFile(const std::string &path, std::string &data) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    return false;
+  char buffer[1 << 16];
+  data.clear();
+  while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+    data.append(buffer, static_cast<std::size_t>(file.gcount()));
+  return !file.bad();
+}
+
+/**
+ * @brief Заголовок журнала для алфавита.
+ * @param alphabet Отпечаток алфавита.
+ * @return Заголовок.
+ */
+JournalHeader makeHeader(std::uint32_t alphabet) {
+  JournalHeader header{};
+  std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+  header.version = JOURNAL_VERSION;
+  header.alphabet = alphabet;
+  return header;
+}
+
+} // namespace
+
+/**
+ * @brief Применяет записи файла журнала к дереву.
+ * @param path Путь к файлу журнала.
+ * @param alphabet Ожидаемый отпечаток алфавита.
+ * @param trie Дерево.
+ * @return Число применённых записей и отброшенных байт.
+ * @throws JournalException если файл не читается, чужого формата или
+ * записан для другого алфавита.
+ */
+JournalReplay replayJournal(const std::string &path, std::uint32_t alphabet, Trie &trie) {
+  JournalReplay result;
+  std::error_code code;
+  if (!std::filesystem::exists(path, code))
+    return result;
+
+  std::string data;
+  if (!readFile(path, data))
+    throw JournalException(path, "не удалось прочитать файл");
+
+  // Сбой при создании файла мог оставить неполный заголовок: журнал пуст.
+  if (data.size() < sizeof(JournalHeader)) {
+    result.discardedBytes = data.size();
+    std::filesystem::resize_file(path, 0, code);
+    return result;
+  }
+
+  JournalHeader header;
+  std::memcpy(&header, data.data(), sizeof(header));
+  if (std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) != 0)
+    throw JournalException(path, "неизвестный формат");
+  if (header.version != JOURNAL_VERSION)
+    throw JournalException(path, "несовместимая версия");
+  if (header.alphabet != alphabet)
+    throw JournalException(path, "записан для другого алфавита");
+
+  std::size_t pos = sizeof(header);
+  while (pos + sizeof(JournalRecord) <= data.size()) {
+    JournalRecord record;
+    std::memcpy(&record, data.data() + pos, sizeof(record));
+    if (pos + sizeof(record) + record.length > data.size())
+      break;
+    std::string_view word(data.data() + pos + sizeof(record), record.length);
+    if (record.checksum != recordChecksum(record, word))
+      break;
+
+    if (record.op == static_cast<std::uint8_t>(JournalOp::Add))
+      trie.insert(word, record.weight);
+    else if (!word.empty())
+      trie.delWord(trie.getRoot(), word, 0);
+    ++result.records;
+    pos += sizeof(record) + record.length;
+  }
+
+  if (pos < data.size()) {
+    result.discardedBytes = data.size() - pos;
+    std::filesystem::resize_file(path, pos, code);
+    if (code)
+      throw JournalException(path, "не удалось отрезать повреждённый хвост");
+  }
+  return result;
+}
+
+/**
+ * @brief Конструктор. Файл не открывается до open.
+ * @param path Путь к журналу.
+ * @param alphabet Отпечаток алфавита.
+ * @param commitWindow Окно группировки fsync.
+ */
+Journal::Journal(std::string path, std::uint32_t alphabet, std::chrono::milliseconds commitWindow)
+    : path(std::move(path)), alphabet(alphabet), commitWindow(commitWindow) {}
+
+/**
+ * @brief Открывает текущий сегмент для дозаписи.
+ * @param truncate Начать сегмент заново.
+ * @throws JournalException если файл не удалось открыть или записать.
+ */
+void Journal::openFile(bool truncate) {
+  std::error_code code;
+  std::uintmax_t existing = std::filesystem::exists(path, code)
+                                ? std::filesystem::file_size(path, code)
+                                : 0;
+  if (code)
+    existing = 0;
+  bool fresh = truncate || existing < sizeof(JournalHeader);
+
+  file = std::fopen(path.c_str(), fresh ? "wb" : "ab");
+  if (!file)
+    throw JournalException(path, "не удалось открыть файл для записи");
+
+  if (fresh) {
+    JournalHeader header = makeHeader(alphabet);
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1 || !syncFile(file)) {
+      std::fclose(file);
+      file = nullptr;
+      throw JournalException(path, "ошибка записи заголовка");
+    }
+    existing = sizeof(header);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  bytes = existing;
+}
+
+/**
+ * @brief Открывает журнал для дозаписи и запускает поток записи.
+ * @throws JournalException если файл не удалось открыть.
+ */
+void Journal::open() {
+  {
+    std::lock_guard<std::mutex> fileLock(fileMutex);
+    openFile(false);
+  }
+  stopping = false;
+  flusher = std::thread(&Journal::flushLoop, this);
+}
+
+/**
+ * @brief Сбрасывает буфер, останавливает поток записи и закрывает файл.
+ */
+void Journal::close() {
+  if (!flusher.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_one();
+  flusher.join();
+
+  std::lock_guard<std::mutex> fileLock(fileMutex);
+  if (file) {
+    std::fclose(file);
+    file = nullptr;
+  }
+}
+
+/**
+ * @brief Цикл потока записи.
+ *
+ * @details Поток спит, пока нет записей. Получив первую, он ждёт окно
+ * группировки (или запрос sync), забирает весь буфер и сбрасывает его
+ * одним fsync.
+ */
+void Journal::flushLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    wake.wait(lock, [&] { return stopping || !pending.empty(); });
+    if (pending.empty())
+      return;
+
+    if (!stopping && !syncRequested)
+      wake.wait_for(lock, commitWindow, [&] { return stopping || syncRequested; });
+
+    std::string batch;
+    batch.swap(pending);
+    std::uint64_t target = appended;
+    syncRequested = false;
+    lock.unlock();
+
+    bool ok;
+    {
+      std::lock_guard<std::mutex> fileLock(fileMutex);
+      ok = file && std::fwrite(batch.data(), batch.size(), 1, file) == 1 && syncFile(file);
+    }
+
+    lock.lock();
+    if (!ok && error.empty())
+      error = "ошибка записи";
+    synced = target;
+    ++commits;
+    durable.notify_all();
+  }
+}
+
+/**
+ * @brief Добавляет запись в буфер.
+ * @param op Операция.
+ * @param word Слово.
+ * @param weight Вес.
+ * @throws JournalException если слово не помещается в запись.
+ */
+void Journal::append(JournalOp op, std::string_view word, std::uint32_t weight) {
+  // Усечённая длина разошлась бы с контрольной суммой, и при воспроизведении
+  // запись и всё после неё сочлись бы повреждённым хвостом.
+  if (word.size() > JOURNAL_MAX_WORD)
+    throw JournalException(path, "слово длиннее " + std::to_string(JOURNAL_MAX_WORD) + " байт");
+
+  JournalRecord record{};
+  record.length = static_cast<std::uint16_t>(word.size());
+  record.op = static_cast<std::uint8_t>(op);
+  record.weight = weight;
+  record.checksum = recordChecksum(record, word);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.append(reinterpret_cast<const char *>(&record), sizeof(record));
+    pending.append(word.data(), word.size());
+    appended += sizeof(record) + word.size();
+    bytes += sizeof(record) + word.size();
+  }
+  wake.notify_one();
+}
+
+/**
+ * @brief Ждёт, пока всё добавленное до вызова окажется на диске.
+ * @throws JournalException если запись на диск не удалась.
+ */
+void Journal::sync() {
+  std::unique_lock<std::mutex> lock(mutex);
+  std::uint64_t target = appended;
+  if (synced < target) {
+    syncRequested = true;
+    wake.notify_one();
+    durable.wait(lock, [&] { return synced >= target; });
+  }
+  if (!error.empty())
+    throw JournalException(path, error);
+}
+
+/**
+ * @brief Переносит записи текущего сегмента в старый.
+ * @throws JournalException если файлы не удалось переписать.
+ */
+void Journal::rotate() {
+  sync();
+  std::lock_guard<std::mutex> fileLock(fileMutex);
+  std::fclose(file);
+  file = nullptr;
+
+  std::string old = oldPath();
+  std::error_code code;
+  bool ok;
+  if (!std::filesystem::exists(old, code)) {
+    ok = std::rename(path.c_str(), old.c_str()) == 0;
+  } else {
+    std::string data;
+    std::FILE *target = nullptr;
+    ok = readFile(path, data) && (target = std::fopen(old.c_str(), "ab")) != nullptr;
+    if (ok && data.size() > sizeof(JournalHeader))
+      ok = std::fwrite(data.data() + sizeof(JournalHeader), data.size() - sizeof(JournalHeader),
+                       1, target) == 1;
+    ok = ok && syncFile(target);
+    if (target)
+      ok = (std::fclose(target) == 0) && ok;
+  }
+
+  // При ошибке записи остаются в текущем сегменте, дозапись продолжается.
+  openFile(ok);
+  if (!ok)
+    throw JournalException(old, "не удалось перенести записи в старый сегмент");
+}
+
+/**
+ * @brief Удаляет старый сегмент.
+ */
+void Journal::dropOld() {
+  std::lock_guard<std::mutex> fileLock(fileMutex);
+  std::remove(oldPath().c_str());
+}
+
+/**
+ * @brief Очищает журнал целиком.
+ * @throws JournalException если файл не удалось переписать.
+ */
+void Journal::reset() {
+  sync();
+  std::lock_guard<std::mutex> fileLock(fileMutex);
+  if (file)
+    std::fclose(file);
+  file = nullptr;
+  std::remove(oldPath().c_str());
+  openFile(true);
+}
+
+/**
+ * @brief Размер текущего сегмента вместе с буфером.
+ * @return Размер в байтах.
+ */
+std::uint64_t Journal::size() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return bytes;
+}
+
+/**
+ * @brief Число выполненных групповых fsync.
+ * @return Количество.
+ */
+std::uint64_t Journal::commitCount() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return commits;
+}
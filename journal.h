@@ -0,0 +1,222 @@
+/**
+ * @file journal.h
+ * @brief Журнал изменений словаря: дозапись с групповым fsync и
+ * воспроизведение после перезапуска.
+ *
+ * @details Файл журнала — заголовок и последовательность записей
+ * "заголовок записи + слово". Запись целостна, если сходится её
+ * контрольная сумма. Хвост после первой обрезанной или битой записи — след
+ * сбоя во время дозаписи — при воспроизведении отбрасывается. Операции
+ * журнала идемпотентны (вставка задаёт вес, удаление убирает слово), поэтому
+ * повторное воспроизведение уже учтённых в снимке записей ничего не меняет.
+ */
+
+#pragma once
+
+#include "prefix_tree.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+/**
+ * @brief Сигнатура файла журнала.
+ */
+constexpr char JOURNAL_MAGIC[8] = {'T', '9', 'J', 'O', 'U', 'R', 'N', '\n'};
+
+/**
+ * @brief Текущая версия формата журнала.
+ */
+constexpr std::uint32_t JOURNAL_VERSION = 1;
+
+/**
+ * @brief Наибольшая длина слова в записи журнала, байт (поле length).
+ */
+constexpr std::size_t JOURNAL_MAX_WORD = 0xFFFF;
+
+/**
+ * @struct JournalHeader
+ * @brief Заголовок файла журнала.
+ */
+struct JournalHeader {
+  char magic[8];          ///< Сигнатура JOURNAL_MAGIC
+  std::uint32_t version;  ///< Версия формата
+  std::uint32_t alphabet; ///< Отпечаток алфавита (BasicAlphabet::FINGERPRINT)
+};
+
+/**
+ * @enum JournalOp
+ * @brief Операция записи журнала.
+ */
+enum class JournalOp : std::uint8_t {
+  Add = 1,   ///< Вставка слова с весом
+  Delete = 2 ///< Удаление слова
+};
+
+/**
+ * @struct JournalRecord
+ * @brief Заголовок записи журнала; за ним следуют length байт слова.
+ */
+struct JournalRecord {
+  std::uint32_t checksum; ///< Контрольная сумма остальных полей и слова
+  std::uint16_t length;   ///< Длина слова в байтах
+  std::uint8_t op;        ///< Операция (JournalOp)
+  std::uint8_t reserved;  ///< Всегда 0
+  std::uint32_t weight;   ///< Вес для вставки (0 для удаления)
+};
+
+static_assert(sizeof(JournalRecord) == 12, "запись журнала не должна содержать выравнивания");
+
+/**
+ * @struct JournalReplay
+ * @brief Итог воспроизведения журнала.
+ */
+struct JournalReplay {
+  std::size_t records = 0;          ///< Применено записей
+  std::uint64_t discardedBytes = 0; ///< Отброшено байт повреждённого хвоста
+};
+
+/**
+ * @brief Применяет записи файла журнала к дереву.
+ * @details Отсутствующий файл — пустой журнал. Повреждённый хвост
+ * отрезается от файла, чтобы новые записи шли за последней целой.
+ * @param path Путь к файлу журнала
+ * @param alphabet Ожидаемый отпечаток алфавита
+ * @param trie Дерево
+ * @return Число применённых записей и отброшенных байт
+ * @throws JournalException если файл не читается, чужого формата или
+ * записан для другого алфавита
+ */
+JournalReplay replayJournal(const std::string &path, std::uint32_t alphabet, Trie &trie);
+
+/**
+ * @class Journal
+ * @brief Дозапись изменений словаря с групповым fsync.
+ *
+ * @details append только кладёт запись в буфер. Фоновый поток забирает
+ * накопленное за окно группировки, пишет одним блоком и вызывает один
+ * fsync на всю группу; sync ждёт, пока на диск попадёт всё добавленное до
+ * вызова. Рядом с журналом может лежать старый сегмент (path + ".old"):
+ * rotate переносит в него текущие записи на время фоновой записи снимка.
+ * Изменяющие методы вызываются из одного потока.
+ */
+class Journal {
+private:
+  std::string path;                       ///< Путь к текущему сегменту
+  std::uint32_t alphabet;                 ///< Отпечаток алфавита
+  std::chrono::milliseconds commitWindow; ///< Окно группировки
+  std::FILE *file = nullptr;              ///< Открытый текущий сегмент
+
+  std::mutex mutex;                  ///< Защищает буфер и счётчики
+  std::mutex fileMutex;              ///< Сериализует работу с файлами
+  std::condition_variable wake;      ///< Будит поток записи
+  std::condition_variable durable;   ///< Будит ждущих в sync
+  std::string pending;               ///< Записи, ещё не отданные на диск
+  std::uint64_t appended = 0;        ///< Байт записей принято всего
+  std::uint64_t synced = 0;          ///< Байт записей сброшено на диск
+  std::uint64_t bytes = 0;           ///< Размер текущего сегмента с буфером
+  std::uint64_t commits = 0;         ///< Выполнено групповых fsync
+  bool syncRequested = false;        ///< Кто-то ждёт в sync: окно не выдерживать
+  bool stopping = false;             ///< Поток записи завершается
+  std::string error;                 ///< Первая ошибка записи
+  std::thread flusher;               ///< Поток записи
+
+  /**
+   * @brief Цикл потока записи.
+   */
+  void flushLoop();
+
+  /**
+   * @brief Открывает текущий сегмент для дозаписи.
+   * @param truncate Начать сегмент заново (только заголовок)
+   * @throws JournalException если файл не удалось открыть или записать
+   */
+  void openFile(bool truncate);
+
+public:
+  /**
+   * @brief Конструктор. Файл не открывается до open.
+   * @param path Путь к журналу
+   * @param alphabet Отпечаток алфавита
+   * @param commitWindow Окно группировки fsync
+   */
+  Journal(std::string path, std::uint32_t alphabet,
+          std::chrono::milliseconds commitWindow = std::chrono::milliseconds(2));
+
+  /**
+   * @brief Деструктор. Сбрасывает буфер и закрывает файл.
+   */
+  ~Journal() { close(); }
+
+  Journal(const Journal &) = delete;
+  Journal &operator=(const Journal &) = delete;
+
+  /**
+   * @brief Открывает журнал для дозаписи и запускает поток записи.
+   * @details Вызывается после replayJournal: файл уже без битого хвоста.
+   * @throws JournalException если файл не удалось открыть
+   */
+  void open();
+
+  /**
+   * @brief Сбрасывает буфер, останавливает поток записи и закрывает файл.
+   */
+  void close();
+
+  /**
+   * @brief Добавляет запись в буфер.
+   * @param op Операция
+   * @param word Слово
+   * @param weight Вес (для вставки)
+   * @throws JournalException если слово длиннее JOURNAL_MAX_WORD
+   */
+  void append(JournalOp op, std::string_view word, std::uint32_t weight = 0);
+
+  /**
+   * @brief Ждёт, пока всё добавленное до вызова окажется на диске.
+   * @throws JournalException если запись на диск не удалась
+   */
+  void sync();
+
+  /**
+   * @brief Переносит записи текущего сегмента в старый и начинает текущий заново.
+   * @details Если старый сегмент уже есть (прошлая запись снимка не
+   * завершилась), записи дописываются в его конец.
+   * @throws JournalException если файлы не удалось переписать
+   */
+  void rotate();
+
+  /**
+   * @brief Удаляет старый сегмент (его записи уже в снимке).
+   */
+  void dropOld();
+
+  /**
+   * @brief Очищает журнал целиком: все записи уже в снимке.
+   * @throws JournalException если файл не удалось переписать
+   */
+  void reset();
+
+  /**
+   * @brief Путь к старому сегменту.
+   * @return path + ".old"
+   */
+  std::string oldPath() const { return path + ".old"; }
+
+  /**
+   * @brief Размер текущего сегмента вместе с буфером.
+   * @return Размер в байтах
+   */
+  std::uint64_t size();
+
+  /**
+   * @brief Число выполненных групповых fsync.
+   * @return Количество
+   */
+  std::uint64_t commitCount();
+};
@@ -0,0 +1,332 @@
+/**
+ * @file louds_trie.cpp
+ * @brief Построение, поиск, запись и загрузка дерева LOUDS.
+ */
+
+#include "louds_trie.h"
+#include "alphabet.h"
+#include "my_exception.h"
+#include "node_arena.h"
+#include "prefix_tree.h"
+#include "trie_snapshot.h"
+#include <cstring>
+#include <iostream>
+
+// === Построение ===
+
+/**
+ * @brief Конструктор. Создаёт пустое дерево.
+ */
+LoudsTrie::LoudsTrie()
+    : bits(nullptr), terminal(nullptr), labels(nullptr), nodes(0), words(0) {}
+
+/**
+ * @brief Кодирует готовое дерево обходом в ширину.
+ * @details Номер узла — его место в очереди обхода; потомки узла
+ * добавляются в порядке индексов символов, поэтому метки потомков
+ * одного узла идут по возрастанию.
+ * @param source Исходное дерево.
+ */
+LoudsTrie::LoudsTrie(const Trie &source) : LoudsTrie() {
+  const Trie::Arena &arena = source.arena;
+  std::vector<NodeId> queue{source.root};
+  std::size_t length = 0;
+
+  auto pushBit = [&](bool one) {
+    if (length % 64 == 0)
+      ownBits.push_back(0);
+    if (one)
+      ownBits.back() |= std::uint64_t(1) << (length % 64);
+    ++length;
+  };
+
+  pushBit(true);
+  pushBit(false);
+  ownLabels.push_back(0);
+
+  for (std::size_t head = 0; head < queue.size(); ++head) {
+    const Trie::Node &n = arena.node(queue[head]);
+    if (head % 64 == 0)
+      ownTerminal.push_back(0);
+    if (n.isEndOfWord) {
+      ownTerminal.back() |= std::uint64_t(1) << (head % 64);
+      ++words;
+    }
+
+    int slot = 0;
+    for (std::uint64_t mask = n.childMask; mask; mask &= mask - 1, ++slot) {
+      pushBit(true);
+      ownLabels.push_back(static_cast<std::uint8_t>(lowestBit64(mask)));
+      queue.push_back(arena.childAt(queue[head], slot));
+    }
+    pushBit(false);
+  }
+
+  nodes = queue.size();
+  bits = ownBits.data();
+  terminal = ownTerminal.data();
+  labels = ownLabels.data();
+  buildDirectory();
+}
+
+/**
+ * @brief Строит каталог rank/select по битам LOUDS.
+ */
+void LoudsTrie::buildDirectory() {
+  std::size_t length = 2 * nodes + 1;
+  std::size_t blocks = (bitWords() + 7) / 8;
+
+  blockRanks.assign(blocks + 1, 0);
+  zeroBlocks.clear();
+
+  std::size_t ones = 0;
+  std::size_t nextSample = 0;
+  for (std::size_t b = 0; b < blocks; ++b) {
+    blockRanks[b] = static_cast<std::uint32_t>(ones);
+    for (std::size_t w = b * 8; w < bitWords() && w < b * 8 + 8; ++w)
+      ones += popcount64(bits[w]);
+
+    std::size_t end = std::min((b + 1) * BLOCK_BITS, length);
+    std::size_t zerosEnd = end - ones;
+    for (; nextSample < zerosEnd; nextSample += ZERO_SAMPLE)
+      zeroBlocks.push_back(static_cast<std::uint32_t>(b));
+  }
+  blockRanks[blocks] = static_cast<std::uint32_t>(ones);
+}
+
+// === Rank/select ===
+
+/**
+ * @brief Позиция нуля с заданным номером.
+ * @details Выборка нулей сужает двоичный поиск по каталогу блоков до
+ * нескольких блоков, внутри блока нули считаются по словам.
+ * @param k Номер нуля (с 0).
+ * @return Позиция бита.
+ */
+std::size_t LoudsTrie::select0(std::size_t k) const {
+  std::size_t sample = k / ZERO_SAMPLE;
+  std::size_t lo = zeroBlocks[sample];
+  std::size_t hi = sample + 1 < zeroBlocks.size() ? zeroBlocks[sample + 1] + 1
+                                                  : blockRanks.size() - 1;
+
+  while (lo + 1 < hi) {
+    std::size_t mid = (lo + hi) / 2;
+    if (mid * BLOCK_BITS - blockRanks[mid] <= k)
+      lo = mid;
+    else
+      hi = mid;
+  }
+
+  k -= lo * BLOCK_BITS - blockRanks[lo];
+  for (std::size_t w = lo * 8;; ++w) {
+    std::uint64_t zeros = ~bits[w];
+    std::size_t count = popcount64(zeros);
+    if (k < count) {
+      for (; k; --k)
+        zeros &= zeros - 1;
+      return w * 64 + lowestBit64(zeros);
+    }
+    k -= count;
+  }
+}
+
+/**
+ * @brief Позиция первого нуля не раньше заданной.
+ * @details У большинства узлов мало потомков, поэтому конец их отрезка
+ * ближе, чем следующий select0.
+ * @param position Начальная позиция.
+ * @return Позиция нуля.
+ */
+std::size_t LoudsTrie::nextZero(std::size_t position) const {
+  std::size_t w = position / 64;
+  std::uint64_t zeros = ~bits[w] >> (position % 64);
+  if (zeros)
+    return position + lowestBit64(zeros);
+
+  while (!(zeros = ~bits[++w]))
+    ;
+  return w * 64 + lowestBit64(zeros);
+}
+
+/**
+ * @brief Находит потомков узла.
+ * @param node Номер узла.
+ * @param first Номер первого потомка.
+ * @return Число потомков.
+ */
+std::size_t LoudsTrie::children(std::size_t node, std::size_t &first) const {
+  std::size_t start = select0(node) + 1;
+  first = start - node - 1;
+  return nextZero(start) - start;
+}
+
+// === Utilities ===
+
+/**
+ * @brief Печатает число узлов, слов и занимаемую память.
+ */
+void LoudsTrie::printMemoryUsage() const {
+  std::size_t structure = (bitWords() + (nodes + 63) / 64) * sizeof(std::uint64_t) +
+                          (blockRanks.size() + zeroBlocks.size()) * sizeof(std::uint32_t);
+  std::size_t bytes = structure + nodes;
+
+  std::cout << "Узлов: " << nodes << ", слов: " << words << ", память: " << bytes << " байт";
+  if (nodes)
+    std::cout << " (" << 8.0 * structure / nodes << " бит на узел + метки)";
+  std::cout << std::endl;
+}
+
+/**
+ * @brief Спускается от корня по префиксу.
+ * @param key Префикс.
+ * @param node Узел после префикса.
+ * @return false, если слов с таким префиксом нет.
+ */
+bool LoudsTrie::walkPrefix(std::string_view key, std::size_t &node) const {
+  if (!nodes)
+    return false;
+
+  node = 0;
+  for (std::size_t position = 0; position < key.size();) {
+    int index = DefaultAlphabet::nextIndex(key, position);
+    if (index == -1)
+      return false;
+
+    std::size_t first;
+    std::size_t count = children(node, first);
+    std::size_t i = 0;
+    while (i < count && labels[first + i] < index)
+      ++i;
+    if (i == count || labels[first + i] != index)
+      return false;
+    node = first + i;
+  }
+  return true;
+}
+
+// === Find ===
+
+/**
+ * @brief Рекурсивно собирает слова из узла.
+ * @param node Текущий узел.
+ * @param outString Буфер собранной строки (восстанавливается после вызова).
+ * @param results Вектор результатов.
+ */
+void LoudsTrie::collectWords(std::size_t node, std::string &outString,
+                             std::vector<std::string> &results) const {
+  if (terminal[node / 64] >> (node % 64) & 1)
+    results.push_back(outString);
+
+  std::size_t first;
+  std::size_t count = children(node, first);
+  std::size_t len = outString.size();
+  for (std::size_t i = 0; i < count; ++i) {
+    outString += DefaultAlphabet::symbol(labels[first + i]);
+    collectWords(first + i, outString, results);
+    outString.resize(len);
+  }
+}
+
+/**
+ * @brief Проверяет наличие слова в словаре.
+ * @param key Слово для поиска.
+ * @return true, если слово найдено.
+ */
+bool LoudsTrie::findOneByKey(std::string_view key) const {
+  std::size_t node;
+  if (key.empty() || !walkPrefix(key, node))
+    return false;
+  return terminal[node / 64] >> (node % 64) & 1;
+}
+
+/**
+ * @brief Находит все слова, начинающиеся с заданного префикса.
+ * @param key Префикс.
+ * @param results Вектор, куда помещаются найденные слова.
+ */
+void LoudsTrie::findAllByKey(std::string_view key, std::vector<std::string> &results) const {
+  results.clear();
+  std::size_t node;
+  if (!walkPrefix(key, node))
+    return;
+
+  std::string outString(key);
+  collectWords(node, outString, results);
+}
+
+// === Файл ===
+
+/**
+ * @brief Записывает дерево в файл.
+ * @param path Путь к файлу.
+ * @throws SnapshotException если файл не удалось записать.
+ */
+void LoudsTrie::save(const std::string &path) const {
+  std::size_t bitBytes = bitWords() * sizeof(std::uint64_t);
+  std::size_t terminalBytes = (nodes + 63) / 64 * sizeof(std::uint64_t);
+
+  LoudsHeader header{};
+  std::memcpy(header.magic, LOUDS_MAGIC, sizeof(header.magic));
+  header.version = LOUDS_VERSION;
+  header.alphabet = DefaultAlphabet::FINGERPRINT;
+  header.nodeCount = nodes;
+  header.words = words;
+  header.checksum = snapshotChecksum(
+      labels, nodes, snapshotChecksum(terminal, terminalBytes, snapshotChecksum(bits, bitBytes)));
+
+  writeFileAtomically(path, {{&header, sizeof(header)},
+                             {bits, bitBytes},
+                             {terminal, terminalBytes},
+                             {labels, nodes}});
+}
+
+/**
+ * @brief Загружает дерево из файла, отображая его в память.
+ * @param path Путь к файлу.
+ * @param verify Проверять контрольную сумму данных.
+ * @throws SnapshotException если файл отсутствует, повреждён или устарел.
+ */
+void LoudsTrie::load(const std::string &path, bool verify) {
+  MappedFile file;
+  if (!file.open(path))
+    throw SnapshotException(path, "не удалось открыть файл");
+
+  if (file.size() < sizeof(LoudsHeader))
+    throw SnapshotException(path, "файл обрезан");
+
+  LoudsHeader header;
+  std::memcpy(&header, file.data(), sizeof(header));
+
+  if (std::memcmp(header.magic, LOUDS_MAGIC, sizeof(header.magic)) != 0)
+    throw SnapshotException(path, "неизвестный формат");
+  if (header.version != LOUDS_VERSION)
+    throw SnapshotException(path, "устаревшая или несовместимая версия");
+  if (header.alphabet != DefaultAlphabet::FINGERPRINT)
+    throw SnapshotException(path, "записан для другого алфавита");
+  if (header.nodeCount == 0 || header.words > header.nodeCount)
+    throw SnapshotException(path, "некорректный заголовок");
+
+  std::size_t count = header.nodeCount;
+  std::size_t bitBytes = (2 * count + 1 + 63) / 64 * sizeof(std::uint64_t);
+  std::size_t terminalBytes = (count + 63) / 64 * sizeof(std::uint64_t);
+  if (file.size() != sizeof(header) + bitBytes + terminalBytes + count)
+    throw SnapshotException(path, "размер файла не совпадает с заголовком");
+
+  const char *data = file.data() + sizeof(header);
+  if (verify && header.checksum != snapshotChecksum(data + bitBytes + terminalBytes, count,
+                                                    snapshotChecksum(data + bitBytes, terminalBytes,
+                                                                     snapshotChecksum(data, bitBytes))))
+    throw SnapshotException(path, "контрольная сумма не совпадает");
+
+  mapping = std::move(file);
+  std::vector<std::uint64_t>().swap(ownBits);
+  std::vector<std::uint64_t>().swap(ownTerminal);
+  std::vector<std::uint8_t>().swap(ownLabels);
+
+  bits = reinterpret_cast<const std::uint64_t *>(data);
+  terminal = reinterpret_cast<const std::uint64_t *>(data + bitBytes);
+  labels = reinterpret_cast<const std::uint8_t *>(data + bitBytes + terminalBytes);
+  nodes = count;
+  words = header.words;
+  buildDirectory();
+}
@@ -0,0 +1,172 @@
+/**
+ * @file louds_trie.h
+ * @brief Сжатое (succinct) префиксное дерево в кодировке LOUDS.
+ *
+ * @details Дерево записывается обходом в ширину: для каждого узла —
+ * столько единиц, сколько у него потомков, и завершающий ноль. Вместе с
+ * фиктивным корнем "10" это 2n + 1 бит на n узлов. Потомки узла x
+ * занимают отрезок между x-м и (x+1)-м нулями, а их номера идут подряд,
+ * поэтому для спуска достаточно операции select0. Метки рёбер хранятся
+ * по байту на узел в том же порядке, признаки конца слова — по биту.
+ */
+
+#pragma once
+
+#include "dictionary.h"
+#include "mapped_file.h"
+#include "prefix_tree.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/**
+ * @brief Сигнатура файла LOUDS.
+ */
+constexpr char LOUDS_MAGIC[8] = {'T', '9', 'L', 'O', 'U', 'D', 'S', '\n'};
+
+/**
+ * @brief Текущая версия формата файла LOUDS (2 — в заголовке есть отпечаток
+ * алфавита).
+ */
+constexpr std::uint32_t LOUDS_VERSION = 2;
+
+/**
+ * @struct LoudsHeader
+ * @brief Заголовок файла LOUDS. За ним следуют биты LOUDS, биты концов
+ * слов (оба — массивы 64-битных слов) и метки узлов.
+ */
+struct LoudsHeader {
+  char magic[8];           ///< Сигнатура LOUDS_MAGIC
+  std::uint32_t version;   ///< Версия формата
+  std::uint32_t alphabet;  ///< Отпечаток алфавита меток
+  std::uint64_t nodeCount; ///< Число узлов
+  std::uint64_t words;     ///< Число слов
+  std::uint64_t checksum;  ///< Контрольная сумма данных
+};
+
+/**
+ * @class LoudsTrie
+ * @brief Неизменяемое дерево около 2 бит на узел плюс метки.
+ *
+ * @details Для select0 строится каталог: число единиц перед каждым
+ * блоком в 512 бит и номер блока для каждого 8192-го нуля. Каталог не
+ * хранится в файле и пересчитывается при загрузке за один проход.
+ * Загруженный файл отображается в память; данные не копируются.
+ */
+class LoudsTrie final : public Dictionary {
+private:
+  static constexpr std::size_t BLOCK_BITS = 512;   ///< Размер блока каталога
+  static constexpr std::size_t ZERO_SAMPLE = 8192; ///< Шаг выборки нулей
+
+  std::vector<std::uint64_t> ownBits;     ///< Биты LOUDS (после построения)
+  std::vector<std::uint64_t> ownTerminal; ///< Биты концов слов (после построения)
+  std::vector<std::uint8_t> ownLabels;    ///< Метки узлов (после построения)
+  MappedFile mapping;                     ///< Отображённый файл (после загрузки)
+
+  const std::uint64_t *bits;     ///< Биты LOUDS
+  const std::uint64_t *terminal; ///< Биты концов слов
+  const std::uint8_t *labels;    ///< Метки узлов (индекс символа)
+  std::size_t nodes;             ///< Число узлов
+  std::size_t words;             ///< Число слов
+
+  std::vector<std::uint32_t> blockRanks; ///< Единиц перед каждым блоком
+  std::vector<std::uint32_t> zeroBlocks; ///< Блок каждого ZERO_SAMPLE-го нуля
+
+  /**
+   * @brief Число 64-битных слов в битах LOUDS.
+   * @return Количество слов
+   */
+  std::size_t bitWords() const { return (2 * nodes + 1 + 63) / 64; }
+
+  /**
+   * @brief Строит каталог rank/select по битам LOUDS.
+   */
+  void buildDirectory();
+
+  /**
+   * @brief Позиция нуля с заданным номером.
+   * @param k Номер нуля (с 0)
+   * @return Позиция бита
+   */
+  std::size_t select0(std::size_t k) const;
+
+  /**
+   * @brief Позиция первого нуля не раньше заданной.
+   * @param position Начальная позиция
+   * @return Позиция нуля
+   */
+  std::size_t nextZero(std::size_t position) const;
+
+  /**
+   * @brief Находит потомков узла.
+   * @param node Номер узла
+   * @param first Номер первого потомка
+   * @return Число потомков
+   */
+  std::size_t children(std::size_t node, std::size_t &first) const;
+
+  /**
+   * @brief Спускается от корня по префиксу.
+   * @param key Префикс
+   * @param node Узел после префикса
+   * @return false, если слов с таким префиксом нет
+   */
+  bool walkPrefix(std::string_view key, std::size_t &node) const;
+
+  /**
+   * @brief Рекурсивно собирает слова из узла.
+   * @param node Текущий узел
+   * @param outString Буфер собранного слова (восстанавливается после вызова)
+   * @param results Список результатов
+   */
+  void collectWords(std::size_t node, std::string &outString,
+                    std::vector<std::string> &results) const;
+
+public:
+  /**
+   * @brief Конструктор. Создаёт пустое дерево.
+   */
+  LoudsTrie();
+
+  /**
+   * @brief Кодирует готовое дерево.
+   * @param source Исходное дерево (не изменяется)
+   */
+  explicit LoudsTrie(const Trie &source);
+
+  LoudsTrie(const LoudsTrie &) = delete;
+  LoudsTrie &operator=(const LoudsTrie &) = delete;
+
+  /**
+   * @brief Число слов в словаре.
+   * @return Количество слов
+   */
+  std::size_t size() const { return words; }
+
+  /**
+   * @brief Печатает число узлов, слов и занимаемую память в битах на узел.
+   */
+  void printMemoryUsage() const;
+
+  /**
+   * @brief Записывает дерево в файл атомарно (writeFileAtomically).
+   * @param path Путь к файлу
+   * @throws SnapshotException если файл не удалось записать
+   */
+  void save(const std::string &path) const;
+
+  /**
+   * @brief Загружает дерево из файла, отображая его в память.
+   * @param path Путь к файлу
+   * @param verify Проверять контрольную сумму данных
+   * @throws SnapshotException если файл отсутствует, повреждён или устарел
+   */
+  void load(const std::string &path, bool verify = true);
+
+  bool findOneByKey(std::string_view key) const override;
+
+  void findAllByKey(std::string_view key, std::vector<std::string> &results) const override;
+};
@@ -0,0 +1,114 @@
+/**
+ * @file mapped_file.cpp
+ * @brief Реализация отображения файла в память.
+ */
+
+#include "mapped_file.h"
+#include <fstream>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Конструктор перемещения.
+ * @param other Перемещаемый объект.
+ */
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : _data(other._data), _size(other._size), _mapped(other._mapped),
+      _buffer(std::move(other._buffer)) {
+  if (!_mapped && _data)
+    _data = _buffer.data();
+  other._data = nullptr;
+  other._size = 0;
+  other._mapped = false;
+}
+
+/**
+ * @brief Присваивание перемещением.
+ * @param other Перемещаемый объект.
+ * @return Ссылка на текущий объект.
+ */
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    release();
+    _data = other._data;
+    _size = other._size;
+    _mapped = other._mapped;
+    _buffer = std::move(other._buffer);
+    if (!_mapped && _data)
+      _data = _buffer.data();
+    other._data = nullptr;
+    other._size = 0;
+    other._mapped = false;
+  }
+  return *this;
+}
+
+/**
+ * @brief Освобождает отображение.
+ */
+void MappedFile::release() {
+#if !defined(_WIN32)
+  if (_mapped && _data)
+    munmap(const_cast<char *>(_data), _size);
+#endif
+  std::vector<char>().swap(_buffer);
+  _data = nullptr;
+  _size = 0;
+  _mapped = false;
+}
+
+/**
+ * @brief Отображает файл в память.
+ * @param path Путь к файлу.
+ * @return false, если файл не удалось открыть или отобразить.
+ */
+bool MappedFile::open(const std::string &path) {
+  release();
+
+#if !defined(_WIN32)
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ::close(fd);
+    return false;
+  }
+
+  void *addr = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED)
+    return false;
+
+  _data = static_cast<const char *>(addr);
+  _size = static_cast<std::size_t>(st.st_size);
+  _mapped = true;
+  return true;
+#else
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file)
+    return false;
+
+  std::streamsize size = file.tellg();
+  if (size <= 0)
+    return false;
+
+  _buffer.resize(static_cast<std::size_t>(size));
+  file.seekg(0);
+  if (!file.read(_buffer.data(), size)) {
+    std::vector<char>().swap(_buffer);
+    return false;
+  }
+
+  _data = _buffer.data();
+  _size = _buffer.size();
+  return true;
+#endif
+}
@@ -0,0 +1,77 @@
+/**
+ * @file mapped_file.h
+ * @brief Отображение файла в память только для чтения.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * @class MappedFile
+ * @brief RAII-обёртка над файлом, отображённым в память только для чтения.
+ *
+ * @details На Unix-подобных системах используется mmap(MAP_SHARED), поэтому
+ * несколько процессов, открывших один файл, разделяют страничный кэш. На
+ * других платформах файл читается в память целиком.
+ */
+class MappedFile {
+private:
+  const char *_data;         ///< Начало данных
+  std::size_t _size;         ///< Размер данных в байтах
+  bool _mapped;              ///< Данные получены через mmap
+  std::vector<char> _buffer; ///< Копия файла, если mmap недоступен
+
+  /**
+   * @brief Освобождает отображение.
+   */
+  void release();
+
+public:
+  /**
+   * @brief Конструктор. Создаёт пустой объект.
+   */
+  MappedFile() : _data(nullptr), _size(0), _mapped(false) {}
+
+  /**
+   * @brief Деструктор. Снимает отображение.
+   */
+  ~MappedFile() { release(); }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  /**
+   * @brief Отображает файл в память.
+   * @param path Путь к файлу
+   * @return false, если файл не удалось открыть или отобразить
+   */
+  bool open(const std::string &path);
+
+  /**
+   * @brief Снимает отображение файла.
+   */
+  void close() { release(); }
+
+  /**
+   * @brief Начало данных файла.
+   * @return Указатель на первый байт или nullptr
+   */
+  const char *data() const { return _data; }
+
+  /**
+   * @brief Размер файла.
+   * @return Размер в байтах
+   */
+  std::size_t size() const { return _size; }
+
+  /**
+   * @brief Проверяет, открыт ли файл.
+   * @return true, если данные доступны
+   */
+  bool isOpen() const { return _data != nullptr; }
+};
@@ -6,6 +6,10 @@
 #include "menu_release.h"
 #include "my_exception.h"
 #include "prefix_tree.h"
+#include "trie_metrics.h"
+#include "typing_session.h"
+#include "utf8_text.h"
+#include <cstdlib>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -13,13 +17,20 @@
 /**
  * @brief Меню поиска автодополнений по префиксу.
  *
+ * @details Префиксы идут через одну сессию набора: если новый префикс
+ * продолжает или укорачивает предыдущий, дерево заново не проходится.
+ * Полный список вариантов при включённом кэше префиксов берётся из кэша.
+ *
  * @param trie Ссылка на префиксное дерево.
  * @param results Вектор для хранения найденных слов.
+ * @param normalize Нормализация введённого слова.
  * @return short 0 — если введена команда "/exit", иначе цикл продолжается.
  *
  * @throws EmptyInputException если ввод пуст.
  */
-short suggMenu(Trie &trie, std::vector<std::string> results) {
+short suggMenu(Trie &trie, std::vector<std::string> results,
+               const NormalizeOptions &normalize) {
+  TypingSession session(trie, 5);
   while (true) {
     std::cout << "Поиск автодополнений. Введите префикс для поиска либо /exit "
                  "для выхода:"
@@ -35,22 +46,53 @@ short suggMenu(Trie &trie, std::vector<std::string> results) {
         return 0;
 
       std::cout << std::endl;
-      trie.findAllByKey(key, results);
+      std::string prefix = normalizeWord(key, normalize);
+      {
+        T9_LATENCY(Metric::SuggLatency);
+        session.assign(prefix);
+        results = session.top();
+      }
 
-      std::cout << "Первые пять вариантов (всего " << results.size()
-                << " результатов):" << std::endl;
-      for (int i = 0; i < std::min<int>(results.size(), 5); ++i) {
-        std::cout << results[i] << " ";
+      std::cout << "Пять лучших вариантов:" << std::endl;
+      for (const auto &result : results) {
+        std::cout << result << " ";
       }
       std::cout << std::endl;
 
-      std::cout << "Вывести все варианты? (да-y / нет -любой другой символ): ";
+      const std::size_t pageSize = 100;
+      std::size_t total = session.count();
+      std::size_t pages = (total + pageSize - 1) / pageSize;
+      std::cout << "Всего " << total << " результатов, страниц по " << pageSize << ": " << pages
+                << "." << std::endl;
+
+      std::cout << "Вывести все варианты? (да-y / номер страницы / нет -любой другой символ): ";
       std::getline(std::cin, key);
 
       if (key.empty())
         throw EmptyInputException();
 
-      if (key == "y") {
+      CompletionCursor cursor = trie.completions(prefix);
+      if (key == "y" && trie.prefixCache()) {
+        trie.findAllByKey(prefix, results);
+        for (const auto &result : results) {
+          std::cout << result << " ";
+        }
+        std::cout << std::endl;
+      } else if (key == "y") {
+        while (cursor.nextPage(pageSize, results)) {
+          for (const auto &result : results) {
+            std::cout << result << " ";
+          }
+        }
+        std::cout << std::endl;
+      } else if (key.find_first_not_of("0123456789") == std::string::npos) {
+        std::size_t page = std::strtoul(key.c_str(), nullptr, 10);
+        if (page == 0 || page > pages) {
+          std::cout << "Нет такой страницы." << std::endl;
+          continue;
+        }
+        cursor.skip((page - 1) * pageSize);
+        cursor.nextPage(pageSize, results);
         for (const auto &result : results) {
           std::cout << result << " ";
         }
@@ -66,12 +108,15 @@ short suggMenu(Trie &trie, std::vector<std::string> results) {
 /**
  * @brief Меню добавления нового слова в словарь.
  *
- * @param trie Ссылка на префиксное дерево.
+ * @param store Словарь с сохранением изменений.
+ * @param normalize Нормализация введённого слова.
  * @return short 0 — если введена команда "/exit", иначе цикл продолжается.
  *
  * @throws EmptyInputException если ввод пуст.
+ * @throws WrongCharException если в слове есть символы не из алфавита.
+ * @throws JournalException если изменение не удалось записать в журнал.
  */
-short addMenu(Trie &trie) {
+short addMenu(DictionaryStore &store, const NormalizeOptions &normalize) {
   while (true) {
     std::cout
         << "Добавление слова в словарь. Введите слово либо /exit для выхода:"
@@ -86,11 +131,17 @@ short addMenu(Trie &trie) {
       if (key == "/exit" || key == "/учше")
         return 0;
 
-      if (trie.findOneByKey(key)) {
+      std::string word = normalizeWord(key, normalize);
+      if (store.trie().findOneByKey(word)) {
         std::cout << "Такое слово уже есть в словаре." << std::endl;
         continue;
       } else {
-        trie.insert(key);
+        {
+          T9_LATENCY(Metric::AddLatency);
+          if (!store.insert(word))
+            throw WrongCharException(key);
+          store.sync();
+        }
         std::cout << "Добавлено." << std::endl;
         continue;
       }
@@ -104,12 +155,14 @@ short addMenu(Trie &trie) {
 /**
  * @brief Меню удаления слова из словаря.
  *
- * @param trie Ссылка на префиксное дерево.
+ * @param store Словарь с сохранением изменений.
+ * @param normalize Нормализация введённого слова.
  * @return short 0 — если введена команда "/exit", иначе цикл продолжается.
  *
  * @throws EmptyInputException если ввод пуст.
+ * @throws JournalException если изменение не удалось записать в журнал.
  */
-short delMenu(Trie &trie) {
+short delMenu(DictionaryStore &store, const NormalizeOptions &normalize) {
   while (true) {
     std::cout
         << "Удаление слова из словаря. Введите слово либо /exit для выхода:"
@@ -124,13 +177,20 @@ short delMenu(Trie &trie) {
       if (key == "/exit" || key == "/учше")
         return 0;
 
-      if (!trie.findOneByKey(key)) {
+      std::string word = normalizeWord(key, normalize);
+      bool removed;
+      {
+        T9_LATENCY(Metric::DelLatency);
+        removed = store.remove(word);
+        if (removed)
+          store.sync();
+      }
+      if (!removed) {
         std::cout << "Такого слова нет в словаре." << std::endl;
         continue;
       } else {
-        trie.delWord(trie.getRoot(), key, 0);
         std::cout << "Удалено." << std::endl;
-        trie.printTrie();
+        store.trie().printTrie();
         continue;
       }
     } catch (const MyException &ex) {
@@ -139,3 +199,103 @@ short delMenu(Trie &trie) {
     }
   }
 }
+
+
+/**
+ * @brief Меню набора слов цифрами телефонной клавиатуры (T9).
+ *
+ * @param trie Ссылка на префиксное дерево.
+ * @return short 0 — если введена команда "/exit", иначе цикл продолжается.
+ *
+ * @throws EmptyInputException если ввод пуст.
+ * @throws WrongCharException если введена не цифра 2-9.
+ */
+short t9Menu(Trie &trie) {
+  while (true) {
+    std::cout << "Режим T9. Введите цифры 2-9 (например, 456) либо /exit для выхода:"
+              << std::endl;
+    std::string key;
+    std::getline(std::cin, key);
+
+    try {
+      if (key.empty())
+        throw EmptyInputException();
+
+      if (key == "/exit" || key == "/учше")
+        return 0;
+
+      for (char digit : key)
+        if (digit < '2' || digit > '9')
+          throw WrongCharException(std::string(1, digit));
+
+      std::vector<std::string> results;
+      trie.findByDigits(key, 10, results);
+
+      if (results.empty()) {
+        std::cout << "Нет слов для этой комбинации." << std::endl;
+        continue;
+      }
+
+      std::cout << "Варианты:" << std::endl;
+      for (const auto &result : results) {
+        std::cout << result << " ";
+      }
+      std::cout << std::endl;
+    } catch (const MyException &ex) {
+      std::cout << " ! " << ex.what() << " Попробуйте еще раз." << std::endl;
+      continue;
+    }
+  }
+}
+
+/**
+ * @brief Меню поиска продолжений префикса с опечатками.
+ *
+ * @details Допустимое расстояние выбирается по длине префикса: одна правка
+ * для префиксов короче шести символов, две — для более длинных.
+ *
+ * @param trie Ссылка на префиксное дерево.
+ * @param normalize Нормализация введённого слова.
+ * @return short 0 — если введена команда "/exit", иначе цикл продолжается.
+ *
+ * @throws EmptyInputException если ввод пуст.
+ */
+short fuzzyMenu(Trie &trie, const NormalizeOptions &normalize) {
+  while (true) {
+    std::cout << "Поиск с опечатками. Введите префикс либо /exit для выхода:" << std::endl;
+    std::string key;
+    std::getline(std::cin, key);
+
+    try {
+      if (key.empty())
+        throw EmptyInputException();
+
+      if (key == "/exit" || key == "/учше")
+        return 0;
+
+      key = normalizeWord(key, normalize);
+      std::size_t length = 0;
+      for (char byte : key)
+        if ((static_cast<unsigned char>(byte) & 0xC0) != 0x80)
+          ++length;
+      unsigned distance = length < 6 ? 1 : 2;
+
+      std::vector<FuzzyMatch> results;
+      trie.findFuzzyByKey(key, distance, 10, results);
+
+      if (results.empty()) {
+        std::cout << "Ничего похожего не найдено." << std::endl;
+        continue;
+      }
+
+      std::cout << "Варианты (в скобках — число исправлений):" << std::endl;
+      for (const auto &result : results) {
+        std::cout << result.word << " (" << result.distance << ") ";
+      }
+      std::cout << std::endl;
+    } catch (const MyException &ex) {
+      std::cout << " ! " << ex.what() << " Попробуйте еще раз." << std::endl;
+      continue;
+    }
+  }
+}
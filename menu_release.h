@@ -5,7 +5,9 @@
 
 #pragma once
 
+#include "dictionary_store.h"
 #include "prefix_tree.h"
+#include "utf8_text.h"
 #include <vector>
 #include <string>
 
@@ -13,20 +15,39 @@
  * @brief Меню автодополнения по префиксу.
  * @param trie Ссылка на префиксное дерево.
  * @param results Вектор для хранения результатов.
+ * @param normalize Нормализация введённого слова.
  * @return short 0 — выход из меню, иначе бесконечный цикл.
  */
-short suggMenu(Trie &trie, std::vector<std::string> results);
+short suggMenu(Trie &trie, std::vector<std::string> results,
+               const NormalizeOptions &normalize = {});
 
 /**
  * @brief Меню добавления слова в словарь.
- * @param trie Ссылка на префиксное дерево.
+ * @param store Словарь с сохранением изменений.
+ * @param normalize Нормализация введённого слова.
  * @return short 0 — выход из меню, иначе бесконечный цикл.
  */
-short addMenu(Trie &trie);
+short addMenu(DictionaryStore &store, const NormalizeOptions &normalize = {});
 
 /**
  * @brief Меню удаления слова из словаря.
+ * @param store Словарь с сохранением изменений.
+ * @param normalize Нормализация введённого слова.
+ * @return short 0 — выход из меню, иначе бесконечный цикл.
+ */
+short delMenu(DictionaryStore &store, const NormalizeOptions &normalize = {});
+
+/**
+ * @brief Меню набора слов цифрами телефонной клавиатуры (T9).
+ * @param trie Ссылка на префиксное дерево.
+ * @return short 0 — выход из меню, иначе бесконечный цикл.
+ */
+short t9Menu(Trie &trie);
+
+/**
+ * @brief Меню поиска продолжений префикса с опечатками.
  * @param trie Ссылка на префиксное дерево.
+ * @param normalize Нормализация введённого слова.
  * @return short 0 — выход из меню, иначе бесконечный цикл.
  */
-short delMenu(Trie &trie);
+short fuzzyMenu(Trie &trie, const NormalizeOptions &normalize = {});
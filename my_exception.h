@@ -68,4 +68,64 @@ public:
    */
   explicit WrongCommandException()
       : MyException("Вы ввели неправильную команду.") {}
-};
\ No newline at end of file
+};
+
+/**
+ * @class SnapshotException
+ * @brief Исключение при ошибке записи или чтения снимка словаря.
+ */
+class SnapshotException : public MyException {
+public:
+  /**
+   * @brief Конструктор с описанием ошибки.
+   * @param path Путь к файлу снимка.
+   * @param reason Причина ошибки.
+   */
+  SnapshotException(const std::string &path, const std::string &reason)
+      : MyException("Снимок словаря " + path + ": " + reason) {}
+};
+
+
+/**
+ * @class JournalException
+ * @brief Исключение при ошибке записи или чтения журнала изменений словаря.
+ */
+class JournalException : public MyException {
+public:
+  /**
+   * @brief Конструктор с описанием ошибки.
+   * @param path Путь к файлу журнала.
+   * @param reason Причина ошибки.
+   */
+  JournalException(const std::string &path, const std::string &reason)
+      : MyException("Журнал изменений " + path + ": " + reason) {}
+};
+
+/**
+ * @class WordListException
+ * @brief Исключение при ошибке чтения файла со списком слов.
+ */
+class WordListException : public MyException {
+public:
+  /**
+   * @brief Конструктор с описанием ошибки.
+   * @param path Путь к файлу.
+   * @param reason Причина ошибки.
+   */
+  WordListException(const std::string &path, const std::string &reason)
+      : MyException("Список слов " + path + ": " + reason) {}
+};
+
+/**
+ * @class UnsortedWordsException
+ * @brief Исключение при нарушении алфавитного порядка слов.
+ */
+class UnsortedWordsException : public MyException {
+public:
+  /**
+   * @brief Конструктор с первым словом, нарушившим порядок.
+   * @param word Слово не на своём месте.
+   */
+  explicit UnsortedWordsException(const std::string &word)
+      : MyException("Слова должны идти по алфавиту, порядок нарушен на: " + word) {}
+};
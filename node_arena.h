@@ -0,0 +1,745 @@
+/**
+ * @file node_arena.h
+ * @brief Пул (арена) узлов Trie с адресацией 32-битными индексами.
+ */
+
+#pragma once
+
+#include "mapped_file.h"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * @brief Индекс узла в арене (вместо 64-битного указателя).
+ */
+using NodeId = std::uint32_t;
+
+/**
+ * @brief Значение "нет узла" (аналог nullptr).
+ */
+constexpr NodeId NO_NODE = 0xFFFFFFFFu;
+
+/**
+ * @brief Подсчёт установленных бит в 64-битной маске.
+ * @param mask Маска
+ * @return Количество единичных бит
+ */
+inline int popcount64(std::uint64_t mask) {
+#if defined(_MSC_VER)
+  return static_cast<int>(__popcnt64(mask));
+#else
+  return __builtin_popcountll(mask);
+#endif
+}
+
+/**
+ * @brief Индекс младшего установленного бита (маска не должна быть нулевой).
+ * @param mask Маска
+ * @return Номер младшего единичного бита
+ */
+inline int lowestBit64(std::uint64_t mask) {
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward64(&index, mask);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctzll(mask);
+#endif
+}
+
+/**
+ * @struct BasicTrieNode
+ * @brief Узел дерева Trie в компактном представлении.
+ *
+ * @details Узел хранит битовую маску присутствующих потомков и смещение
+ * плотного блока их индексов в пуле ссылок арены. Позиция потомка в блоке
+ * равна числу единичных бит маски ниже его индекса. Число слов поддерева
+ * и признак конца слова делят одно 32-битное поле, поэтому узел занимает
+ * 24 байта с 64-битной маской и 20 байт с 32-битной.
+ *
+ * @tparam Mask Тип маски потомков (задаётся алфавитом)
+ */
+template <typename Mask> struct BasicTrieNode {
+  Mask childMask;          ///< Маска присутствующих потомков (бит = индекс символа)
+  NodeId children;         ///< Смещение блока потомков в пуле ссылок
+  std::uint32_t weight;    ///< Вес слова, оканчивающегося в узле
+  std::uint32_t maxWeight; ///< Наибольший вес слова в поддереве узла
+  std::uint32_t words : 31;      ///< Число слов в поддереве (включая сам узел)
+  std::uint32_t isEndOfWord : 1; ///< Признак конца слова
+
+  /**
+   * @brief Конструктор по умолчанию.
+   */
+  BasicTrieNode()
+      : childMask(0), children(NO_NODE), weight(0), maxWeight(0), words(0), isEndOfWord(0) {}
+
+  /**
+   * @brief Количество потомков узла.
+   * @return Число установленных бит маски
+   */
+  int childCount() const { return popcount64(childMask); }
+
+  /**
+   * @brief Позиция потомка с заданным индексом в плотном блоке.
+   * @param index Индекс символа в алфавите
+   * @return Смещение внутри блока
+   */
+  int slotOf(int index) const { return popcount64(childMask & ((Mask(1) << index) - 1)); }
+
+  /**
+   * @brief Проверяет наличие потомка с заданным индексом.
+   * @param index Индекс символа в алфавите
+   * @return true, если потомок есть
+   */
+  bool hasChild(int index) const { return childMask & (Mask(1) << index); }
+};
+
+/**
+ * @brief Число классов размера блоков потомков: 1, 2, 4, ..., 64 ссылок.
+ */
+constexpr int ARENA_SIZE_CLASSES = 7;
+
+/**
+ * @struct ArenaState
+ * @brief Служебное состояние арены, сохраняемое в снимке.
+ */
+struct ArenaState {
+  std::uint32_t freeNodes;                       ///< Голова списка свободных узлов
+  std::uint32_t freeBlocks[ARENA_SIZE_CLASSES];  ///< Головы списков свободных блоков
+  std::uint64_t liveNodes;                       ///< Число занятых узлов
+};
+
+/**
+ * @struct ArenaUsage
+ * @brief Заполненность арены: занятые и свободные слоты.
+ */
+struct ArenaUsage {
+  std::size_t liveNodes; ///< Занятые узлы
+  std::size_t deadNodes; ///< Освобождённые слоты узлов (ждут повторного использования)
+  std::size_t liveLinks; ///< Слоты ссылок вне списков свободных блоков
+  std::size_t deadLinks; ///< Слоты ссылок в свободных блоках
+};
+
+/**
+ * @class BasicNodeArena
+ * @brief Арена узлов и блоков ссылок на потомков.
+ *
+ * @details Узлы лежат в одном непрерывном массиве и адресуются NodeId.
+ * Освобождённые узлы попадают в интрузивный список свободных и
+ * переиспользуются. Блоки потомков выделяются из пула ссылок классами
+ * размеров 1, 2, 4, ..., 64 с отдельным списком свободных блоков на класс.
+ * Уничтожение арены — освобождение двух массивов, без обхода дерева.
+ *
+ * Арена может быть подключена к отображённому в память снимку: тогда чтение
+ * идёт прямо из файла, а при первом изменении данные копируются в
+ * собственные массивы (копирование при записи).
+ *
+ * @tparam Node Тип узла: конструктор по умолчанию, поля childMask и
+ * children, методы childCount(), slotOf() и hasChild() как у BasicTrieNode
+ */
+template <typename Node> class BasicNodeArena {
+public:
+  static constexpr int SIZE_CLASSES = ARENA_SIZE_CLASSES; ///< Классы блоков: 1..64 ссылок
+
+  using State = ArenaState; ///< Служебное состояние для снимка
+
+private:
+  std::vector<Node> _nodes;           ///< Все узлы
+  std::vector<NodeId> _links;             ///< Пул блоков потомков
+  const Node *_nodeData;              ///< Узлы для чтения (массив или снимок)
+  const NodeId *_linkData;                ///< Ссылки для чтения (массив или снимок)
+  std::size_t _nodeCount;                 ///< Число слотов узлов
+  std::size_t _linkCount;                 ///< Число слотов ссылок
+  MappedFile _mapping;                    ///< Подключённый снимок
+  NodeId _freeNodes;                      ///< Голова списка свободных узлов
+  NodeId _freeBlocks[SIZE_CLASSES];       ///< Головы списков свободных блоков
+  std::size_t _liveNodes;                 ///< Число занятых узлов
+
+  /**
+   * @brief Обновляет указатели чтения после изменения массивов.
+   */
+  void syncViews() {
+    _nodeData = _nodes.data();
+    _linkData = _links.data();
+    _nodeCount = _nodes.size();
+    _linkCount = _links.size();
+  }
+
+  /**
+   * @brief Копирует подключённый снимок в собственные массивы.
+   */
+  void ensureOwned() {
+    if (_mapping.isOpen())
+      detach();
+  }
+
+  /**
+   * @brief Отключает снимок, скопировав его данные.
+   */
+  void detach();
+
+  /**
+   * @brief Класс размера блока для заданного числа потомков.
+   * @param count Число потомков (> 0)
+   * @return Номер класса (вместимость 1 << класс)
+   */
+  static int sizeClass(int count);
+
+  /**
+   * @brief Выделяет блок ссылок заданного класса.
+   * @param cls Класс размера
+   * @return Смещение блока в пуле ссылок
+   */
+  NodeId allocBlock(int cls);
+
+  /**
+   * @brief Возвращает блок ссылок в список свободных.
+   * @param offset Смещение блока
+   * @param cls Класс размера
+   */
+  void freeBlock(NodeId offset, int cls);
+
+public:
+  /**
+   * @brief Конструктор. Создаёт пустую арену.
+   */
+  BasicNodeArena();
+
+  /**
+   * @brief Доступ к узлу по индексу.
+   * @param id Индекс узла
+   * @return Ссылка на узел
+   */
+  Node &node(NodeId id) {
+    ensureOwned();
+    return _nodes[id];
+  }
+
+  /**
+   * @brief Доступ к узлу по индексу (только чтение).
+   * @param id Индекс узла
+   * @return Константная ссылка на узел
+   */
+  const Node &node(NodeId id) const { return _nodeData[id]; }
+
+  /**
+   * @brief Индекс потомка в позиции slot плотного блока узла.
+   * @param id Индекс узла
+   * @param slot Позиция в блоке
+   * @return Индекс потомка
+   */
+  NodeId childAt(NodeId id, int slot) const { return _linkData[_nodeData[id].children + slot]; }
+
+  /**
+   * @brief Возвращает потомка по индексу символа.
+   * @param id Индекс узла
+   * @param index Индекс символа в алфавите
+   * @return Индекс потомка или NO_NODE
+   */
+  NodeId getChild(NodeId id, int index) const {
+    const Node &n = _nodeData[id];
+    if (!n.hasChild(index))
+      return NO_NODE;
+    return _linkData[n.children + n.slotOf(index)];
+  }
+
+  /**
+   * @brief Выделяет новый узел (из списка свободных либо в конце массива).
+   * @return Индекс нового узла
+   */
+  NodeId allocNode();
+
+  /**
+   * @brief Возвращает узел в список свободных вместе с его блоком потомков.
+   * @param id Индекс узла (потомки должны быть уже отсоединены)
+   */
+  void freeNode(NodeId id);
+
+  /**
+   * @brief Добавляет потомка (индекс не должен присутствовать в маске).
+   * @param id Индекс узла-родителя
+   * @param index Индекс символа в алфавите
+   * @param child Индекс нового потомка
+   */
+  void addChild(NodeId id, int index, NodeId child);
+
+  /**
+   * @brief Заменяет существующего потомка без перестройки блока.
+   * @param id Индекс узла-родителя
+   * @param index Индекс символа в алфавите (потомок должен быть)
+   * @param child Индекс нового потомка
+   */
+  void setChild(NodeId id, int index, NodeId child) {
+    ensureOwned();
+    _links[_nodes[id].children + _nodes[id].slotOf(index)] = child;
+  }
+
+  /**
+   * @brief Убирает потомка из узла (сам потомок не освобождается).
+   * @param id Индекс узла-родителя
+   * @param index Индекс символа в алфавите
+   */
+  void removeChild(NodeId id, int index);
+
+  /**
+   * @brief Резервирует место под узлы и ссылки.
+   * @param nodes Ожидаемое число узлов
+   * @param links Ожидаемое число ссылок
+   */
+  void reserve(std::size_t nodes, std::size_t links) {
+    ensureOwned();
+    _nodes.reserve(nodes);
+    _links.reserve(links);
+    syncViews();
+  }
+
+  /**
+   * @brief Переносит в арену все узлы другой арены.
+   *
+   * @details Узлы и пул ссылок другой арены дописываются в конец массивов
+   * со сдвигом индексов, её списки свободных присоединяются к собственным.
+   * Используется для сшивания независимо построенных поддеревьев.
+   *
+   * @param other Арена-источник (не изменяется)
+   * @param otherNode Индекс узла в арене-источнике
+   * @return Новый индекс этого узла в текущей арене
+   */
+  NodeId graft(const BasicNodeArena &other, NodeId otherNode);
+
+  /**
+   * @brief Освобождает все узлы разом.
+   */
+  void clear();
+
+  /**
+   * @brief Число занятых узлов.
+   * @return Количество живых узлов
+   */
+  std::size_t liveNodes() const { return _liveNodes; }
+
+  /**
+   * @brief Заполненность арены.
+   * @details Свободные ссылки считаются обходом списков свободных блоков.
+   * @return Занятые и свободные слоты узлов и ссылок
+   */
+  ArenaUsage usage() const;
+
+  /**
+   * @brief Перекладывает живые узлы подряд в порядке обхода в глубину.
+   *
+   * @details Узлы, достижимые из root, копируются в новые массивы в прямом
+   * порядке обхода: первый потомок идёт сразу за родителем, блоки потомков —
+   * в том же порядке и без свободных промежутков. Списки свободных
+   * очищаются, лишняя память возвращается. Все прежние индексы узлов
+   * становятся недействительными.
+   *
+   * @param root Индекс корня
+   * @return Новый индекс корня (0)
+   */
+  NodeId compact(NodeId root);
+
+  /**
+   * @brief Память, занятая ареной (вместимость массивов).
+   * @return Размер в байтах
+   */
+  std::size_t memoryUsage() const {
+    if (_mapping.isOpen())
+      return _nodeCount * sizeof(Node) + _linkCount * sizeof(NodeId);
+    return _nodes.capacity() * sizeof(Node) + _links.capacity() * sizeof(NodeId);
+  }
+
+  // === Снимки ===
+
+  /**
+   * @brief Массив узлов для записи в снимок.
+   * @return Указатель на первый узел
+   */
+  const Node *nodeData() const { return _nodeData; }
+
+  /**
+   * @brief Число слотов узлов (включая свободные).
+   * @return Размер массива узлов
+   */
+  std::size_t nodeCount() const { return _nodeCount; }
+
+  /**
+   * @brief Пул ссылок для записи в снимок.
+   * @return Указатель на первую ссылку
+   */
+  const NodeId *linkData() const { return _linkData; }
+
+  /**
+   * @brief Число слотов ссылок (включая свободные блоки).
+   * @return Размер пула ссылок
+   */
+  std::size_t linkCount() const { return _linkCount; }
+
+  /**
+   * @brief Служебное состояние для записи в снимок.
+   * @return Списки свободных и число живых узлов
+   */
+  State state() const;
+
+  /**
+   * @brief Подключает отображённый снимок вместо собственных массивов.
+   * @param mapping Отображённый файл (переходит во владение арены)
+   * @param nodes Начало массива узлов внутри файла
+   * @param nodeCount Число узлов
+   * @param links Начало пула ссылок внутри файла
+   * @param linkCount Число ссылок
+   * @param state Служебное состояние из снимка
+   */
+  void attach(MappedFile &&mapping, const Node *nodes, std::size_t nodeCount,
+              const NodeId *links, std::size_t linkCount, const State &state);
+
+  /**
+   * @brief Проверяет, читаются ли данные из снимка.
+   * @return true, если подключён снимок
+   */
+  bool isMapped() const { return _mapping.isOpen(); }
+};
+
+// === Реализация BasicNodeArena ===
+
+/**
+ * @brief Конструктор. Создаёт пустую арену.
+ */
+template <typename Node>
+BasicNodeArena<Node>::BasicNodeArena()
+    : _nodeData(nullptr), _linkData(nullptr), _nodeCount(0), _linkCount(0),
+      _freeNodes(NO_NODE), _liveNodes(0) {
+  for (int i = 0; i < SIZE_CLASSES; ++i)
+    _freeBlocks[i] = NO_NODE;
+}
+
+/**
+ * @brief Класс размера блока для заданного числа потомков.
+ * @param count Число потомков (> 0).
+ * @return Номер класса: наименьшее c, при котором (1 << c) >= count.
+ */
+template <typename Node>
+int BasicNodeArena<Node>::sizeClass(int count) {
+  int cls = 0;
+  while ((1 << cls) < count)
+    ++cls;
+  return cls;
+}
+
+/**
+ * @brief Выделяет блок ссылок заданного класса.
+ * @param cls Класс размера.
+ * @return Смещение блока в пуле ссылок.
+ */
+template <typename Node>
+NodeId BasicNodeArena<Node>::allocBlock(int cls) {
+  NodeId offset = _freeBlocks[cls];
+  if (offset != NO_NODE) {
+    _freeBlocks[cls] = _links[offset];
+    return offset;
+  }
+
+  offset = static_cast<NodeId>(_links.size());
+  _links.resize(_links.size() + (std::size_t(1) << cls), NO_NODE);
+  syncViews();
+  return offset;
+}
+
+/**
+ * @brief Возвращает блок ссылок в список свободных.
+ * @param offset Смещение блока.
+ * @param cls Класс размера.
+ */
+template <typename Node>
+void BasicNodeArena<Node>::freeBlock(NodeId offset, int cls) {
+  _links[offset] = _freeBlocks[cls];
+  _freeBlocks[cls] = offset;
+}
+
+/**
+ * @brief Выделяет новый узел.
+ * @return Индекс нового узла.
+ */
+template <typename Node>
+NodeId BasicNodeArena<Node>::allocNode() {
+  ensureOwned();
+  NodeId id = _freeNodes;
+  if (id != NO_NODE) {
+    _freeNodes = _nodes[id].children;
+    _nodes[id] = Node();
+  } else {
+    id = static_cast<NodeId>(_nodes.size());
+    _nodes.emplace_back();
+    syncViews();
+  }
+  ++_liveNodes;
+  return id;
+}
+
+/**
+ * @brief Возвращает узел в список свободных.
+ * @param id Индекс узла.
+ */
+template <typename Node>
+void BasicNodeArena<Node>::freeNode(NodeId id) {
+  ensureOwned();
+  Node &n = _nodes[id];
+  if (n.childMask)
+    freeBlock(n.children, sizeClass(n.childCount()));
+
+  n = Node();
+  n.children = _freeNodes;
+  _freeNodes = id;
+  --_liveNodes;
+}
+
+/**
+ * @brief Добавляет потомка с сохранением порядка индексов в блоке.
+ * @param id Индекс узла-родителя.
+ * @param index Индекс символа в алфавите.
+ * @param child Индекс нового потомка.
+ */
+template <typename Node>
+void BasicNodeArena<Node>::addChild(NodeId id, int index, NodeId child) {
+  ensureOwned();
+  int count = _nodes[id].childCount();
+  int slot = _nodes[id].slotOf(index);
+  int oldClass = count ? sizeClass(count) : -1;
+  int newClass = sizeClass(count + 1);
+
+  if (newClass != oldClass) {
+    NodeId block = allocBlock(newClass);
+    NodeId old = _nodes[id].children;
+    for (int i = 0; i < count; ++i)
+      _links[block + i] = _links[old + i];
+    if (oldClass >= 0)
+      freeBlock(old, oldClass);
+    _nodes[id].children = block;
+  }
+
+  NodeId base = _nodes[id].children;
+  for (int i = count; i > slot; --i)
+    _links[base + i] = _links[base + i - 1];
+  _links[base + slot] = child;
+  _nodes[id].childMask |= decltype(Node::childMask)(1) << index;
+}
+
+/**
+ * @brief Убирает потомка из узла.
+ * @param id Индекс узла-родителя.
+ * @param index Индекс символа в алфавите.
+ */
+template <typename Node>
+void BasicNodeArena<Node>::removeChild(NodeId id, int index) {
+  ensureOwned();
+  Node &n = _nodes[id];
+  if (!n.hasChild(index))
+    return;
+
+  int count = n.childCount();
+  int slot = n.slotOf(index);
+  for (int i = slot; i + 1 < count; ++i)
+    _links[n.children + i] = _links[n.children + i + 1];
+  n.childMask &= ~(decltype(Node::childMask)(1) << index);
+
+  int oldClass = sizeClass(count);
+  if (count == 1) {
+    freeBlock(n.children, oldClass);
+    n.children = NO_NODE;
+    return;
+  }
+
+  int newClass = sizeClass(count - 1);
+  if (newClass != oldClass) {
+    NodeId block = allocBlock(newClass);
+    NodeId old = _nodes[id].children;
+    for (int i = 0; i < count - 1; ++i)
+      _links[block + i] = _links[old + i];
+    freeBlock(old, oldClass);
+    _nodes[id].children = block;
+  }
+}
+
+/**
+ * @brief Переносит в арену все узлы другой арены.
+ * @param other Арена-источник.
+ * @param otherNode Индекс узла в арене-источнике.
+ * @return Новый индекс узла в текущей арене.
+ */
+template <typename Node>
+NodeId BasicNodeArena<Node>::graft(const BasicNodeArena &other, NodeId otherNode) {
+  ensureOwned();
+  NodeId nodeBase = static_cast<NodeId>(_nodes.size());
+  NodeId linkBase = static_cast<NodeId>(_links.size());
+
+  _nodes.insert(_nodes.end(), other._nodeData, other._nodeData + other._nodeCount);
+  _links.insert(_links.end(), other._linkData, other._linkData + other._linkCount);
+
+  for (std::size_t i = nodeBase; i < _nodes.size(); ++i) {
+    Node &n = _nodes[i];
+    if (!n.childMask)
+      continue;
+    n.children += linkBase;
+    for (int k = 0; k < n.childCount(); ++k)
+      _links[n.children + k] += nodeBase;
+  }
+
+  // Списки свободных: узлы связаны через поле children, блоки — через первый слот.
+  NodeId tail = NO_NODE;
+  for (NodeId id = other._freeNodes; id != NO_NODE; id = other._nodeData[id].children) {
+    NodeId next = other._nodeData[id].children;
+    _nodes[nodeBase + id].children = next == NO_NODE ? _freeNodes : next + nodeBase;
+    tail = id;
+  }
+  if (tail != NO_NODE)
+    _freeNodes = other._freeNodes + nodeBase;
+
+  for (int cls = 0; cls < SIZE_CLASSES; ++cls) {
+    tail = NO_NODE;
+    for (NodeId off = other._freeBlocks[cls]; off != NO_NODE; off = other._linkData[off]) {
+      NodeId next = other._linkData[off];
+      _links[linkBase + off] = next == NO_NODE ? _freeBlocks[cls] : next + linkBase;
+      tail = off;
+    }
+    if (tail != NO_NODE)
+      _freeBlocks[cls] = other._freeBlocks[cls] + linkBase;
+  }
+
+  _liveNodes += other._liveNodes;
+  syncViews();
+  return otherNode + nodeBase;
+}
+
+/**
+ * @brief Заполненность арены.
+ * @return Занятые и свободные слоты узлов и ссылок.
+ */
+template <typename Node>
+ArenaUsage BasicNodeArena<Node>::usage() const {
+  ArenaUsage result{};
+  result.liveNodes = _liveNodes;
+  result.deadNodes = _nodeCount - _liveNodes;
+  for (int cls = 0; cls < SIZE_CLASSES; ++cls)
+    for (NodeId off = _freeBlocks[cls]; off != NO_NODE; off = _linkData[off])
+      result.deadLinks += std::size_t(1) << cls;
+  result.liveLinks = _linkCount - result.deadLinks;
+  return result;
+}
+
+/**
+ * @brief Перекладывает живые узлы подряд в порядке обхода в глубину.
+ * @param root Индекс корня.
+ * @return Новый индекс корня.
+ */
+template <typename Node>
+NodeId BasicNodeArena<Node>::compact(NodeId root) {
+  std::vector<Node> nodes;
+  std::vector<NodeId> links;
+  nodes.reserve(_liveNodes);
+
+  // В стеке — старый индекс узла и слот ссылки родителя, который нужно
+  // заполнить новым индексом. Потомки кладутся в обратном порядке, чтобы
+  // первый из них получил номер сразу за родителем.
+  std::vector<std::pair<NodeId, NodeId>> stack{{root, NO_NODE}};
+  while (!stack.empty()) {
+    std::pair<NodeId, NodeId> top = stack.back();
+    stack.pop_back();
+
+    NodeId id = static_cast<NodeId>(nodes.size());
+    nodes.push_back(_nodeData[top.first]);
+    if (top.second != NO_NODE)
+      links[top.second] = id;
+
+    int count = nodes.back().childCount();
+    if (!count) {
+      nodes.back().children = NO_NODE;
+      continue;
+    }
+
+    NodeId block = static_cast<NodeId>(links.size());
+    links.resize(links.size() + (std::size_t(1) << sizeClass(count)), NO_NODE);
+    NodeId old = nodes.back().children;
+    nodes.back().children = block;
+    for (int i = count - 1; i >= 0; --i)
+      stack.emplace_back(_linkData[old + i], block + i);
+  }
+
+  _mapping.close();
+  _nodes.swap(nodes);
+  _links.swap(links);
+  syncViews();
+  _freeNodes = NO_NODE;
+  for (int i = 0; i < SIZE_CLASSES; ++i)
+    _freeBlocks[i] = NO_NODE;
+  _liveNodes = _nodes.size();
+  return 0;
+}
+
+/**
+ * @brief Освобождает все узлы разом.
+ */
+template <typename Node>
+void BasicNodeArena<Node>::clear() {
+  _mapping.close();
+  std::vector<Node>().swap(_nodes);
+  std::vector<NodeId>().swap(_links);
+  syncViews();
+  _freeNodes = NO_NODE;
+  for (int i = 0; i < SIZE_CLASSES; ++i)
+    _freeBlocks[i] = NO_NODE;
+  _liveNodes = 0;
+}
+
+/**
+ * @brief Служебное состояние для записи в снимок.
+ * @return Списки свободных и число живых узлов.
+ */
+template <typename Node>
+typename BasicNodeArena<Node>::State BasicNodeArena<Node>::state() const {
+  State st{};
+  st.freeNodes = _freeNodes;
+  for (int i = 0; i < SIZE_CLASSES; ++i)
+    st.freeBlocks[i] = _freeBlocks[i];
+  st.liveNodes = _liveNodes;
+  return st;
+}
+
+/**
+ * @brief Подключает отображённый снимок вместо собственных массивов.
+ * @param mapping Отображённый файл.
+ * @param nodes Начало массива узлов внутри файла.
+ * @param nodeCount Число узлов.
+ * @param links Начало пула ссылок внутри файла.
+ * @param linkCount Число ссылок.
+ * @param state Служебное состояние из снимка.
+ */
+template <typename Node>
+void BasicNodeArena<Node>::attach(MappedFile &&mapping, const Node *nodes, std::size_t nodeCount,
+                       const NodeId *links, std::size_t linkCount, const State &state) {
+  clear();
+  _mapping = std::move(mapping);
+  _nodeData = nodes;
+  _nodeCount = nodeCount;
+  _linkData = links;
+  _linkCount = linkCount;
+  _freeNodes = state.freeNodes;
+  for (int i = 0; i < SIZE_CLASSES; ++i)
+    _freeBlocks[i] = state.freeBlocks[i];
+  _liveNodes = static_cast<std::size_t>(state.liveNodes);
+}
+
+/**
+ * @brief Отключает снимок, скопировав его данные в собственные массивы.
+ */
+template <typename Node>
+void BasicNodeArena<Node>::detach() {
+  _nodes.assign(_nodeData, _nodeData + _nodeCount);
+  _links.assign(_linkData, _linkData + _linkCount);
+  _mapping.close();
+  syncViews();
+}
@@ -0,0 +1,144 @@
+/**
+ * @file prefix_cache.cpp
+ * @brief Реализация кэша ответов на префиксные запросы.
+ */
+
+#include "prefix_cache.h"
+#include <iterator>
+
+namespace {
+
+/**
+ * @brief Накладные расходы записи сверх строк: узел списка, узел и
+ * корзина хэш-таблицы, копия ключа в таблице.
+ */
+constexpr std::size_t ENTRY_OVERHEAD = 128;
+
+/**
+ * @brief Оценка памяти, занятой строкой.
+ * @param text Строка.
+ * @return Размер объекта строки плюс буфер, если он вне объекта.
+ */
+std::size_t stringBytes(std::string_view text) {
+  // Короткие строки хранятся в самом объекте (SSO).
+  return sizeof(std::string) + (text.size() < sizeof(std::string) ? 0 : text.size() + 1);
+}
+
+} // namespace
+
+/**
+ * @brief Конструктор.
+ * @param capacity Предел памяти в байтах.
+ */
+PrefixCache::PrefixCache(std::size_t capacity) { counters.capacity = capacity; }
+
+/**
+ * @brief Удаляет запись.
+ * @param it Запись.
+ */
+void PrefixCache::erase(Order::iterator it) {
+  counters.bytes -= it->bytes;
+  index.erase(it->prefix);
+  order.erase(it);
+}
+
+/**
+ * @brief Ищет ответ на префикс.
+ * @param prefix Префикс.
+ * @param results Ответ.
+ * @return true при попадании.
+ */
+bool PrefixCache::lookup(std::string_view prefix, std::vector<std::string> &results) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = index.find(std::string(prefix));
+  if (found == index.end()) {
+    ++counters.misses;
+    return false;
+  }
+
+  order.splice(order.begin(), order, found->second);
+  const Entry &entry = *found->second;
+  results = entry.words;
+  ++counters.hits;
+  counters.savedNodes += entry.visited;
+  counters.savedNanos += entry.nanos;
+  return true;
+}
+
+/**
+ * @brief Кладёт ответ в кэш, вытесняя давно не использованные записи.
+ * @param prefix Префикс.
+ * @param words Ответ.
+ * @param visited Узлов пройдено при построении ответа.
+ * @param nanos Время построения ответа, нс.
+ */
+void PrefixCache::store(std::string_view prefix, const std::vector<std::string> &words,
+                        std::uint64_t visited, std::uint64_t nanos) {
+  std::size_t bytes = ENTRY_OVERHEAD + 2 * stringBytes(prefix) +
+                      words.size() * sizeof(std::string);
+  for (const std::string &word : words)
+    bytes += stringBytes(word) - sizeof(std::string);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (bytes > counters.capacity / 4)
+    return;
+
+  auto found = index.find(std::string(prefix));
+  if (found != index.end())
+    erase(found->second);
+
+  while (!order.empty() && counters.bytes + bytes > counters.capacity) {
+    erase(std::prev(order.end()));
+    ++counters.evictions;
+  }
+
+  order.push_front(Entry{std::string(prefix), words, bytes, visited, nanos});
+  index.emplace(order.front().prefix, order.begin());
+  counters.bytes += bytes;
+  ++counters.stores;
+}
+
+/**
+ * @brief Сбрасывает записи всех префиксов слова.
+ * @param word Изменённое слово.
+ */
+void PrefixCache::invalidate(std::string_view word) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (index.empty())
+    return;
+
+  std::string prefix;
+  prefix.reserve(word.size());
+  for (std::size_t length = 0;; ++length) {
+    auto found = index.find(prefix);
+    if (found != index.end()) {
+      erase(found->second);
+      ++counters.invalidations;
+    }
+    if (length == word.size())
+      break;
+    prefix += word[length];
+  }
+}
+
+/**
+ * @brief Сбрасывает все записи.
+ */
+void PrefixCache::clear() {
+  std::lock_guard<std::mutex> lock(mutex);
+  counters.invalidations += order.size();
+  order.clear();
+  index.clear();
+  counters.bytes = 0;
+}
+
+/**
+ * @brief Текущие счётчики.
+ * @return Копия счётчиков.
+ */
+PrefixCacheStats PrefixCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  PrefixCacheStats result = counters;
+  result.entries = order.size();
+  return result;
+}
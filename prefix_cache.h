@@ -0,0 +1,121 @@
+/**
+ * @file prefix_cache.h
+ * @brief Кэш ответов на префиксные запросы с ограничением по памяти.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @struct PrefixCacheStats
+ * @brief Счётчики кэша префиксов.
+ */
+struct PrefixCacheStats {
+  std::uint64_t hits = 0;          ///< Ответов из кэша
+  std::uint64_t misses = 0;        ///< Промахов
+  std::uint64_t stores = 0;        ///< Записей добавлено
+  std::uint64_t evictions = 0;     ///< Записей вытеснено по памяти
+  std::uint64_t invalidations = 0; ///< Записей сброшено изменениями словаря
+  std::uint64_t savedNodes = 0;    ///< Узлов дерева, которые не пришлось обходить
+  std::uint64_t savedNanos = 0;    ///< Оценка сэкономленного времени обхода, нс
+  std::size_t entries = 0;         ///< Записей сейчас
+  std::size_t bytes = 0;           ///< Занято памяти
+  std::size_t capacity = 0;        ///< Предел памяти
+};
+
+/**
+ * @class PrefixCache
+ * @brief LRU-кэш списков слов по префиксу, ограниченный в байтах.
+ *
+ * @details Ключ — префикс в том виде, в каком его получил findAllByKey,
+ * значение — полный ответ. Размер записи оценивается по длине ключа и слов
+ * с накладными расходами строк и узлов списка; при превышении предела
+ * вытесняются давно не использованные записи. Ответ больше четверти
+ * предела не кэшируется, чтобы один широкий префикс не вытеснял всё
+ * остальное.
+ *
+ * Изменение слова w затрагивает только ответы на префиксы w, поэтому
+ * invalidate(w) перебирает префиксы w (включая пустой) и сбрасывает только
+ * их записи. Вместе с ответом хранятся число пройденных при его построении
+ * узлов и время обхода: попадание прибавляет их к сэкономленному.
+ *
+ * Методы потокобезопасны (внутренний мьютекс).
+ */
+class PrefixCache {
+private:
+  /**
+   * @struct Entry
+   * @brief Запись кэша.
+   */
+  struct Entry {
+    std::string prefix;               ///< Префикс
+    std::vector<std::string> words;   ///< Ответ
+    std::size_t bytes;                ///< Оценка занятой памяти
+    std::uint64_t visited;            ///< Узлов пройдено при построении ответа
+    std::uint64_t nanos;              ///< Время построения ответа, нс
+  };
+
+  using Order = std::list<Entry>; ///< Записи от недавних к давним
+
+  mutable std::mutex mutex;                                      ///< Защищает всё ниже
+  Order order;                                                   ///< Порядок использования
+  std::unordered_map<std::string, Order::iterator> index;        ///< Префикс -> запись
+  PrefixCacheStats counters;                                     ///< Счётчики
+
+  /**
+   * @brief Удаляет запись.
+   * @param it Запись
+   */
+  void erase(Order::iterator it);
+
+public:
+  /**
+   * @brief Конструктор.
+   * @param capacity Предел памяти в байтах
+   */
+  explicit PrefixCache(std::size_t capacity);
+
+  /**
+   * @brief Ищет ответ на префикс.
+   * @param prefix Префикс
+   * @param results Ответ (заполняется при попадании)
+   * @return true при попадании
+   */
+  bool lookup(std::string_view prefix, std::vector<std::string> &results);
+
+  /**
+   * @brief Кладёт ответ в кэш.
+   * @param prefix Префикс
+   * @param words Ответ
+   * @param visited Узлов пройдено при построении ответа
+   * @param nanos Время построения ответа, нс
+   */
+  void store(std::string_view prefix, const std::vector<std::string> &words,
+             std::uint64_t visited, std::uint64_t nanos);
+
+  /**
+   * @brief Сбрасывает ответы, которые могло изменить добавление или
+   * удаление слова: записи всех префиксов слова.
+   * @param word Изменённое слово
+   */
+  void invalidate(std::string_view word);
+
+  /**
+   * @brief Сбрасывает все записи (словарь изменился целиком).
+   */
+  void clear();
+
+  /**
+   * @brief Текущие счётчики.
+   * @return Копия счётчиков
+   */
+  PrefixCacheStats stats() const;
+};
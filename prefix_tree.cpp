@@ -5,129 +5,368 @@
 
 #include "prefix_tree.h"
 #include "my_exception.h"
+#include "trie_metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
 #include <iostream>
+#include <queue>
 #include <vector>
 
+namespace {
+
+/**
+ * @struct TopCandidate
+ * @brief Кандидат очереди поиска "лучший-первым": поддерево (раскрыть)
+ * либо готовое слово (выдать).
+ */
+struct TopCandidate {
+  std::uint32_t weight; ///< Вес слова или наибольший вес поддерева
+  std::string word;     ///< Путь до узла
+  NodeId node;          ///< Индекс узла
+  bool isWord;          ///< Кандидат — само слово узла
+
+  bool operator<(const TopCandidate &other) const {
+    if (weight != other.weight)
+      return weight < other.weight;
+    return word > other.word;
+  }
+};
+
+/**
+ * @brief Выдаёт слова из очереди по убыванию веса, раскрывая поддеревья.
+ * @tparam Alphabet Алфавит дерева.
+ * @tparam Arena Тип арены узлов.
+ * @param arena Арена дерева.
+ * @param queue Очередь, заполненная начальными кандидатами.
+ * @param k Размер results, на котором выдача останавливается.
+ * @param results Вектор, в конец которого добавляются слова.
+ */
+template <typename Alphabet, typename Arena>
+void drainTop(const Arena &arena, std::priority_queue<TopCandidate> &queue, std::size_t k,
+              std::vector<std::string> &results) {
+  while (!queue.empty() && results.size() < k) {
+    TopCandidate top = queue.top();
+    queue.pop();
+
+    if (top.isWord) {
+      results.push_back(std::move(top.word));
+      continue;
+    }
+
+    const auto &n = arena.node(top.node);
+    if (n.isEndOfWord)
+      queue.push({n.weight, top.word, top.node, true});
+
+    int slot = 0;
+    for (std::uint64_t mask = n.childMask; mask; mask &= mask - 1, ++slot) {
+      NodeId child = arena.childAt(top.node, slot);
+      std::string word = top.word;
+      word += Alphabet::symbol(lowestBit64(mask));
+      queue.push({arena.node(child).maxWeight, std::move(word), child, false});
+    }
+  }
+}
+
+} // namespace
+
 // === Getters ===
 
 /**
  * @brief Получает индекс символа в алфавите.
  * @param word Строка, содержащая символ (может быть многобайтный UTF-8).
- * @return Индекс символа в массиве alphabet или -1, если не найден.
+ * @return Индекс символа в алфавите дерева или -1, если не найден.
  */
-int Trie::getCharIndex(const std::string &word) const {
+template <typename Alphabet>
+int BasicTrie<Alphabet>::getCharIndex(std::string_view word) const {
   if (word.empty())
     return -1;
-  std::size_t charLen = getUtf8CharLen((unsigned char)word[0]);
+  std::size_t pos = 0;
+  return Alphabet::nextIndex(word, pos);
+}
 
-  if (charLen > word.size())
-    return -1;
+/**
+ * @brief Возвращает индекс корня дерева.
+ * @return Индекс корневого узла в арене.
+ */
+template <typename Alphabet>
+NodeId BasicTrie<Alphabet>::getRoot() const {
+  return root;
+}
 
-  std::string ch = word.substr(0, charLen);
+// === Utilities ===
 
-  for (int i = 0; i < ALPHABET_SIZE; ++i)
-    if (ch == alphabet[i])
-      return i;
+/**
+ * @brief Проверяет, что слово непустое и состоит только из символов алфавита.
+ * @param word Слово UTF-8.
+ * @return true, если слово можно вставить целиком.
+ */
+template <typename Alphabet>
+bool BasicTrie<Alphabet>::isValidWord(std::string_view word) const {
+  if (word.empty())
+    return false;
+  for (std::size_t pos = 0; pos < word.size();)
+    if (Alphabet::nextIndex(word, pos) == -1)
+      return false;
+  return true;
+}
 
-  return -1;
+/**
+ * @brief Проверяет, является ли узел листом.
+ * @param node Индекс узла.
+ * @return true, если у узла нет потомков.
+ */
+template <typename Alphabet>
+bool BasicTrie<Alphabet>::isLeaf(NodeId node) const {
+  return arena.node(node).childMask == 0;
 }
 
 /**
- * @brief Возвращает указатель на корень дерева.
- * @return Указатель на корневой TrieNode.
+ * @brief Пересчитывает наибольший вес и число слов поддерева узла по его потомкам.
+ * @param node Индекс узла.
+ * @return true, если хотя бы одно значение изменилось.
  */
-TrieNode *Trie::getRoot() {
-  return root;
+template <typename Alphabet>
+bool BasicTrie<Alphabet>::refreshSubtree(NodeId node) {
+  const Node &n = arena.node(node);
+  std::uint32_t best = n.isEndOfWord ? n.weight : 0;
+  std::uint32_t words = n.isEndOfWord;
+
+  for (int i = 0; i < n.childCount(); ++i) {
+    const Node &child = arena.node(arena.childAt(node, i));
+    best = std::max(best, child.maxWeight);
+    words += child.words;
+  }
+
+  if (best == n.maxWeight && words == n.words)
+    return false;
+  arena.node(node).maxWeight = best;
+  arena.node(node).words = words;
+  return true;
 }
 
-// === Utilities ===
+/**
+ * @brief Спускается от корня по префиксу.
+ * @param key Префикс.
+ * @return Индекс узла префикса или NO_NODE.
+ */
+template <typename Alphabet>
+NodeId BasicTrie<Alphabet>::walkPrefix(std::string_view key) const {
+  NodeId node = root;
+  for (size_t position = 0; position < key.size();) {
+    int index = Alphabet::nextIndex(key, position);
+    if (index == -1)
+      return NO_NODE;
+    node = arena.getChild(node, index);
+    if (node == NO_NODE)
+      return NO_NODE;
+  }
+  return node;
+}
 
 /**
- * @brief Определяет длину UTF-8 символа по первому байту.
- * @param ch Первый байт символа.
- * @return Количество байт в символе (1-4).
+ * @brief Печатает число узлов, слов и занимаемую деревом память.
  */
-std::size_t Trie::getUtf8CharLen(unsigned char ch) const {
-  if ((ch & 0x80) == 0)
-    return 1;
-  else if ((ch & 0xE0) == 0xC0)
-    return 2;
-  else if ((ch & 0xF0) == 0xE0)
-    return 3;
-  else if ((ch & 0xF8) == 0xF0)
-    return 4;
-  return 1;
+template <typename Alphabet>
+void BasicTrie<Alphabet>::printMemoryUsage() const {
+  std::size_t words = arena.node(root).words;
+  std::size_t nodes = arena.liveNodes();
+  std::size_t bytes = arena.memoryUsage();
+
+  std::cout << "Узлов: " << nodes << ", слов: " << words << ", память: " << bytes
+            << " байт";
+  if (words)
+    std::cout << " (" << bytes / words << " байт на слово)";
+  std::cout << std::endl;
+
+  ArenaUsage usage = arena.usage();
+  if (usage.deadNodes || usage.deadLinks)
+    std::cout << "Свободно после удалений: узлов " << usage.deadNodes << ", ссылок "
+              << usage.deadLinks << std::endl;
 }
 
 /**
- * @brief Проверяет, содержит ли узел дочерние элементы.
- * @param node Указатель на узел.
- * @return true, если есть хотя бы один дочерний элемент.
+ * @brief Заполненность арены.
+ * @return Счётчики арены.
  */
-bool Trie::isLeaf(TrieNode *node) const {
-  for (int i = 0; i < ALPHABET_SIZE; ++i)
-    if (node->children[i] != nullptr)
-      return true;
-  return false;
+template <typename Alphabet>
+ArenaUsage BasicTrie<Alphabet>::nodeUsage() const {
+  return arena.usage();
+}
+
+/**
+ * @brief Форма дерева.
+ * @details Обход в глубину с явным стеком.
+ * @return Число узлов и слов, память, распределение по глубинам.
+ */
+template <typename Alphabet>
+TrieShape BasicTrie<Alphabet>::shape() const {
+  TrieShape result;
+  result.bytes = arena.memoryUsage();
+  result.arena = arena.usage();
+
+  std::vector<std::pair<NodeId, std::size_t>> stack{{root, 0}};
+  while (!stack.empty()) {
+    NodeId node = stack.back().first;
+    std::size_t depth = stack.back().second;
+    stack.pop_back();
+
+    const Node &n = arena.node(node);
+    if (result.nodesByDepth.size() <= depth) {
+      result.nodesByDepth.resize(depth + 1);
+      result.wordsByDepth.resize(depth + 1);
+    }
+    ++result.nodes;
+    ++result.nodesByDepth[depth];
+    if (n.isEndOfWord) {
+      ++result.words;
+      ++result.wordsByDepth[depth];
+    }
+    for (int slot = 0; slot < n.childCount(); ++slot)
+      stack.emplace_back(arena.childAt(node, slot), depth + 1);
+  }
+  return result;
 }
 
 // === Setters ===
 
 /**
  * @brief Вставляет слово в Trie.
+ *
+ * @details Максимумы весов на пути обновляются при спуске. Если слово уже
+ * было в дереве с большим весом, максимумы пересчитываются снизу вверх.
+ * Счётчики слов на пути увеличиваются только для нового слова, вторым
+ * проходом: до конца слова неизвестно, было ли оно в дереве. Слово
+ * проверяется до спуска, чтобы не оставлять в дереве недостроенный путь.
+ *
  * @param word Слово для вставки.
+ * @param weight Вес слова.
+ * @return false, если слово пустое или содержит символы не из алфавита.
  */
-void Trie::insert(const std::string &word) {
-  TrieNode *node = root;
+template <typename Alphabet>
+bool BasicTrie<Alphabet>::insert(std::string_view word, std::uint32_t weight) {
+  if (!isValidWord(word))
+    return false;
+
+  NodeId node = root;
   size_t i = 0;
 
   while (i < word.size()) {
-    std::size_t charLen = getUtf8CharLen((unsigned char)word[i]);
-    int index = getCharIndex(word.substr(i));
+    int index = Alphabet::nextIndex(word, i);
 
-    if (index == -1)
-      return;
+    arena.node(node).maxWeight = std::max(arena.node(node).maxWeight, weight);
 
-    if (!node->children[index])
-      node->children[index] = new TrieNode();
+    NodeId child = arena.getChild(node, index);
+    if (child == NO_NODE) {
+      child = arena.allocNode();
+      arena.addChild(node, index, child);
+    }
 
-    node = node->children[index];
-    i += charLen;
+    node = child;
   }
 
-  node->isEndOfWord = true;
+  Node &last = arena.node(node);
+  bool added = !last.isEndOfWord;
+  bool lowered = !added && weight < last.weight;
+  last.isEndOfWord = true;
+  last.weight = weight;
+  last.maxWeight = std::max(last.maxWeight, weight);
+
+  if (keypad)
+    keypad->add(word, weight);
+  if (cache && added)
+    cache->invalidate(word);
+
+  if (added) {
+    node = root;
+    ++arena.node(node).words;
+    for (size_t pos = 0; pos < word.size();) {
+      node = arena.getChild(node, Alphabet::nextIndex(word, pos));
+      ++arena.node(node).words;
+    }
+  }
+
+  if (!lowered)
+    return true;
+
+  std::vector<NodeId> path{root};
+  for (size_t pos = 0; pos < word.size();)
+    path.push_back(arena.getChild(path.back(), Alphabet::nextIndex(word, pos)));
+
+  for (auto it = path.rbegin(); it != path.rend(); ++it)
+    if (!refreshSubtree(*it))
+      break;
+  return true;
 }
 
 /**
- * @brief Рекурсивно удаляет слово из дерева.
- * @param node Текущий узел.
+ * @brief Удаляет слово из дерева.
+ *
+ * @details Спуск по слову от корня запоминает путь; префикс
+ * word[0, position) должен привести в узел node, иначе слово не удаляется.
+ * Если слово есть, с его узла снимается отметка конца слова, а затем снизу
+ * вверх освобождаются узлы, которые больше не ведут ни к одному слову: без
+ * потомков и без отметки. Освобождённые узлы и блоки потомков уходят в
+ * списки свободных арены. Максимумы весов и счётчики слов пересчитываются
+ * по всему пути от корня, включая предков node.
+ *
+ * @param node Узел, в который ведёт префикс word[0, position).
  * @param word Удаляемое слово.
- * @param position Текущая позиция в строке.
+ * @param position Позиция в строке, соответствующая узлу node.
+ * @return true, если слово было в дереве и удалено.
  * @throws EmptyInputException если строка пустая.
  */
-void Trie::delWord(TrieNode *node, const std::string &word, int position) {
+template <typename Alphabet>
+bool BasicTrie<Alphabet>::delWord(NodeId node, std::string_view word, std::size_t position) {
   if (word.empty())
     throw EmptyInputException();
 
-  if (position < word.size()) {
-    std::size_t charLen = getUtf8CharLen((unsigned char)word[position]);
-    int index = getCharIndex(word.substr(position));
+  std::vector<std::pair<NodeId, int>> path; // узел и индекс символа, ведущего к нему
+  path.emplace_back(root, -1);
+  bool reached = node == root && position == 0;
+  for (std::size_t pos = 0; pos < word.size();) {
+    int index = Alphabet::nextIndex(word, pos);
+    NodeId child = index == -1 ? NO_NODE : arena.getChild(path.back().first, index);
+    if (child == NO_NODE)
+      return false;
+    path.emplace_back(child, index);
+    if (pos == position && child == node)
+      reached = true;
+  }
 
-    position += charLen;
-    if (position < word.size())
-      delWord(node->children[index], word, position);
+  if (!reached || !arena.node(path.back().first).isEndOfWord)
+    return false;
 
-    if (isLeaf(node->children[index])) {
-      if (position == word.size()) {
-        node->children[index]->isEndOfWord = false;
-        return;
-      }
-    } else {
-      delete node->children[index];
-      node->children[index] = nullptr;
-      return;
-    }
+  if (keypad)
+    keypad->remove(word);
+  if (cache)
+    cache->invalidate(word);
+
+  Node &last = arena.node(path.back().first);
+  last.isEndOfWord = false;
+  last.weight = 0;
+
+  while (path.size() > 1) {
+    NodeId current = path.back().first;
+    const Node &n = arena.node(current);
+    if (n.childMask != 0 || n.isEndOfWord)
+      break;
+    arena.removeChild(path[path.size() - 2].first, path.back().second);
+    arena.freeNode(current);
+    path.pop_back();
   }
+
+  for (auto it = path.rbegin(); it != path.rend(); ++it)
+    refreshSubtree(it->first);
+  return true;
+}
+
+/**
+ * @brief Перестраивает дерево в арене подряд в порядке обхода в глубину.
+ */
+template <typename Alphabet>
+void BasicTrie<Alphabet>::compact() {
+  root = arena.compact(root);
 }
 
 // === Print ===
@@ -137,28 +376,33 @@ void Trie::delWord(TrieNode *node, const std::string &word, int position) {
  * @param node Текущий узел.
  * @param outString Текущая собранная строка.
  */
-void Trie::printTrieRecur(TrieNode *node, std::string outString) {
-  TrieNode *current = node;
+template <typename Alphabet>
+void BasicTrie<Alphabet>::printTrieRecur(NodeId node, std::string outString) {
+  NodeId current = node;
 
-  if (!isLeaf(current)) {
+  if (isLeaf(current)) {
     std::cout << std::endl;
     return;
   }
 
-  for (int i = 0; i < ALPHABET_SIZE; ++i) {
-    if (current->children[i] != nullptr) {
-      if (current->children[i]->isEndOfWord) {
-        std::cout << outString + alphabet[i] << "* ";
-      }
-      printTrieRecur(current->children[i], outString + alphabet[i]);
+  int slot = 0;
+  for (std::uint64_t mask = arena.node(current).childMask; mask; mask &= mask - 1, ++slot) {
+    int i = lowestBit64(mask);
+    NodeId child = arena.childAt(current, slot);
+    std::string next = outString;
+    next += Alphabet::symbol(i);
+    if (arena.node(child).isEndOfWord) {
+      std::cout << next << "* ";
     }
+    printTrieRecur(child, next);
   }
 }
 
 /**
  * @brief Печатает все слова, содержащиеся в Trie.
  */
-void Trie::printTrie() {
+template <typename Alphabet>
+void BasicTrie<Alphabet>::printTrie() {
   std::string outString = "";
   std::cout << std::endl;
   printTrieRecur(root, outString);
@@ -167,60 +411,72 @@ void Trie::printTrie() {
 // === Find ===
 
 /**
- * @brief Поиск полного совпадения по ключу (рекурсивно).
+ * @brief Поиск полного совпадения по ключу.
  * @param node Узел, с которого начинается поиск.
  * @param key Строка-ключ.
  * @param position Текущая позиция.
  * @return true, если слово найдено и оно конечное.
  */
-bool Trie::findKeyWord(TrieNode *node, const std::string &key, size_t position) const {
-  std::size_t charLen = getUtf8CharLen((unsigned char)key[position]);
-  int index = getCharIndex(key.substr(position, charLen));
-
-  if (index == -1 || !node->children[index])
+template <typename Alphabet>
+bool BasicTrie<Alphabet>::findKeyWord(NodeId node, std::string_view key, size_t position) const {
+  if (position >= key.size())
     return false;
 
-  position += charLen;
+  while (position < key.size()) {
+    int index = Alphabet::nextIndex(key, position);
+    if (index == -1)
+      return false;
 
-  if (position == key.size())
-    return node->children[index]->isEndOfWord;
+    node = arena.getChild(node, index);
+    if (node == NO_NODE)
+      return false;
+  }
 
-  return findKeyWord(node->children[index], key, position);
+  return arena.node(node).isEndOfWord;
 }
 
 /**
- * @brief Рекурсивный сбор всех слов, начинающихся с префикса.
+ * @brief Сбор всех слов, начинающихся с префикса.
+ * @details Префикс проходится итеративно, затем поддерево обходится
+ * рекурсивно.
  * @param node Текущий узел.
  * @param key Префикс.
  * @param position Текущая позиция.
- * @param outString Собранная строка.
+ * @param outString Буфер собранной строки (восстанавливается после вызова).
  * @param results Вектор результатов.
+ * @return Число пройденных узлов.
  */
-void Trie::findAllWords(TrieNode *node, const std::string &key, size_t position,
-                        std::string outString, std::vector<std::string> &results) const {
-  if (position < key.size()) {
-    std::size_t charLen = getUtf8CharLen((unsigned char)key[position]);
-    int index = getCharIndex(key.substr(position, charLen));
-
-    if (index == -1 || !node->children[index])
-      return;
-
-    position += charLen;
-    outString += alphabet[index];
+template <typename Alphabet>
+std::size_t BasicTrie<Alphabet>::findAllWords(NodeId node, std::string_view key, size_t position,
+                        std::string &outString, std::vector<std::string> &results) const {
+  std::size_t restoreLen = outString.size();
+  std::size_t visited = 1;
+
+  while (position < key.size()) {
+    int index = Alphabet::nextIndex(key, position);
+    node = index == -1 ? NO_NODE : arena.getChild(node, index);
+    if (node == NO_NODE) {
+      outString.resize(restoreLen);
+      return visited;
+    }
 
-    findAllWords(node->children[index], key, position, outString, results);
-    return;
+    outString += Alphabet::symbol(index);
+    ++visited;
   }
 
-  if (node->isEndOfWord) {
+  if (arena.node(node).isEndOfWord) {
     results.push_back(outString);
   }
 
-  for (int i = 0; i < ALPHABET_SIZE; ++i) {
-    if (node->children[i] != nullptr) {
-      findAllWords(node->children[i], key, position, outString + alphabet[i], results);
-    }
+  std::size_t nodeLen = outString.size();
+  int slot = 0;
+  for (std::uint64_t mask = arena.node(node).childMask; mask; mask &= mask - 1, ++slot) {
+    outString += Alphabet::symbol(lowestBit64(mask));
+    visited += findAllWords(arena.childAt(node, slot), key, position, outString, results);
+    outString.resize(nodeLen);
   }
+  outString.resize(restoreLen);
+  return visited;
 }
 
 /**
@@ -228,17 +484,456 @@ void Trie::findAllWords(TrieNode *node, const std::string &key, size_t position,
  * @param key Слово для поиска.
  * @return true, если слово найдено.
  */
-bool Trie::findOneByKey(const std::string &key) const {
+template <typename Alphabet>
+bool BasicTrie<Alphabet>::findOneByKey(std::string_view key) const {
   return findKeyWord(root, key, 0);
 }
 
+/**
+ * @brief Возвращает вес слова.
+ * @param key Слово для поиска.
+ * @return Вес слова или 0, если слова нет.
+ */
+template <typename Alphabet>
+std::uint32_t BasicTrie<Alphabet>::getWeight(std::string_view key) const {
+  NodeId node = walkPrefix(key);
+  if (node == NO_NODE)
+    return 0;
+
+  const Node &n = arena.node(node);
+  return n.isEndOfWord ? n.weight : 0;
+}
+
+/**
+ * @brief Находит k слов с наибольшим весом среди слов с заданным префиксом.
+ * @param key Префикс.
+ * @param k Наибольшее число результатов.
+ * @param results Вектор найденных слов.
+ */
+template <typename Alphabet>
+void BasicTrie<Alphabet>::findTopByKey(std::string_view key, std::size_t k,
+                        std::vector<std::string> &results) const {
+  results.clear();
+  NodeId node = walkPrefix(key);
+  if (node != NO_NODE)
+    collectTop(node, key, k, results);
+}
+
+/**
+ * @brief Находит k самых тяжёлых слов поддерева узла.
+ * @param node Узел префикса.
+ * @param prefix Путь до узла.
+ * @param k Наибольшее число результатов.
+ * @param results Вектор найденных слов.
+ */
+template <typename Alphabet>
+void BasicTrie<Alphabet>::collectTop(NodeId node, std::string_view prefix, std::size_t k,
+                      std::vector<std::string> &results) const {
+  results.clear();
+  std::priority_queue<TopCandidate> queue;
+  queue.push({arena.node(node).maxWeight, std::string(prefix), node, false});
+  drainTop<Alphabet>(arena, queue, k, results);
+}
+
 /**
  * @brief Находит все слова, начинающиеся с заданного префикса.
+ * @details Если кэш включён, ответ сначала ищется в нём, а построенный
+ * обходом ответ кладётся в кэш вместе с числом пройденных узлов и временем.
  * @param key Префикс.
  * @param results Вектор, куда помещаются найденные слова.
  */
-void Trie::findAllByKey(const std::string &key, std::vector<std::string> &results) const {
+template <typename Alphabet>
+void BasicTrie<Alphabet>::findAllByKey(std::string_view key, std::vector<std::string> &results) const {
+  if (cache && cache->lookup(key, results))
+    return;
+
+  auto start = cache ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
   results.clear();
   std::string outString = "";
-  findAllWords(root, key, 0, outString, results);
-}
\ No newline at end of file
+  std::size_t visited = findAllWords(root, key, 0, outString, results);
+  T9_RECORD(Metric::FindAllVisited, visited);
+  T9_RECORD(Metric::FindAllResults, results.size());
+
+  if (cache)
+    cache->store(key, results, visited,
+                 static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                std::chrono::steady_clock::now() - start)
+                                                .count()));
+}
+
+/**
+ * @brief Включает или выключает кэш ответов findAllByKey.
+ * @param bytes Предел памяти кэша (0 — выключить).
+ */
+template <typename Alphabet>
+void BasicTrie<Alphabet>::enableCache(std::size_t bytes) {
+  cache.reset(bytes ? new PrefixCache(bytes) : nullptr);
+}
+
+/**
+ * @brief Рекурсивно добавляет слова поддерева в индекс T9.
+ * @param node Текущий узел.
+ * @param path Буфер пути до узла.
+ * @param index Заполняемый индекс.
+ */
+template <typename Alphabet>
+void BasicTrie<Alphabet>::collectKeypad(NodeId node, std::string &path, T9Index &index) const {
+  const Node &n = arena.node(node);
+  if (n.isEndOfWord)
+    index.add(path, n.weight);
+
+  std::size_t len = path.size();
+  int slot = 0;
+  for (std::uint64_t mask = n.childMask; mask; mask &= mask - 1, ++slot) {
+    path += Alphabet::symbol(lowestBit64(mask));
+    collectKeypad(arena.childAt(node, slot), path, index);
+    path.resize(len);
+  }
+}
+
+/**
+ * @brief Находит слова, набираемые последовательностью цифр клавиатуры.
+ * @param digits Цифры 2..9.
+ * @param k Наибольшее число результатов.
+ * @param results Вектор найденных слов.
+ */
+template <typename Alphabet>
+void BasicTrie<Alphabet>::findByDigits(std::string_view digits, std::size_t k,
+                        std::vector<std::string> &results) const {
+  if (!keypad) {
+    keypad.reset(new T9Index());
+    std::string path;
+    collectKeypad(root, path, *keypad);
+  }
+  keypad->find(digits, k, results);
+}
+
+/**
+ * @brief Находит продолжения префикса, набранного с опечатками.
+ *
+ * @details Поиск идёт ступенями по расстоянию t = 0, 1, ... и
+ * останавливается, как только набрано k слов. Поэтому запрос без опечаток
+ * стоит как обычный поиск по префиксу, а широкий обход с двумя правками
+ * нужен только тогда, когда ближе нет k слов.
+ *
+ * На ступени t дерево обходится с явным стеком, строки таблицы расстояний
+ * хранятся подряд по глубинам. Для узла известно best — наименьшее
+ * расстояние от запроса до пути на отрезке от корня до узла. Минимум
+ * строки с глубиной не убывает, поэтому если он не меньше best, всё
+ * поддерево получает расстояние best без спуска. Если он больше t, ветка
+ * отсекается. Поддеревья и отдельные слова с расстоянием ровно t
+ * раскрываются поиском "лучший-первым".
+ *
+ * @param key Префикс.
+ * @param maxDistance Допустимое расстояние.
+ * @param k Наибольшее число результатов.
+ * @param results Вектор найденных слов.
+ */
+template <typename Alphabet>
+void BasicTrie<Alphabet>::findFuzzyByKey(std::string_view key, unsigned maxDistance, std::size_t k,
+                          std::vector<FuzzyMatch> &results) const {
+  results.clear();
+  if (k == 0)
+    return;
+  maxDistance = std::min(maxDistance, MAX_FUZZY_DISTANCE);
+
+  std::vector<int> query;
+  for (std::size_t position = 0; position < key.size();) {
+    std::size_t start = position;
+    query.push_back(Alphabet::nextIndex(key, position));
+    if (position == start)
+      position = key.size();
+  }
+
+  const std::size_t width = query.size() + 1;
+  std::vector<unsigned> rows(width);
+  for (std::size_t j = 0; j < width; ++j)
+    rows[j] = static_cast<unsigned>(j);
+
+  /// Состояние обхода узла, ниже которого идёт спуск.
+  struct Frame {
+    NodeId node;         ///< Индекс узла
+    std::uint64_t mask;  ///< Ещё не пройденные потомки
+    int slot;            ///< Позиция следующего потомка в блоке
+    unsigned best;       ///< Наименьшее расстояние на пути до узла
+  };
+
+  std::vector<Frame> stack;
+  std::vector<std::size_t> pathLens;
+  std::string path;
+  std::vector<TopCandidate> level;
+  std::vector<std::string> words;
+
+  for (unsigned threshold = 0; threshold <= maxDistance && results.size() < k; ++threshold) {
+    // Отсекает узел, берёт его поддерево целиком или ставит в стек для спуска.
+    auto visit = [&](NodeId node, std::size_t depth, unsigned best) {
+      const unsigned *row = &rows[depth * width];
+      best = std::min(best, row[width - 1]);
+      unsigned rowMin = *std::min_element(row, row + width);
+      const Node &n = arena.node(node);
+
+      if (best <= threshold && rowMin >= best) {
+        if (best == threshold)
+          level.push_back({n.maxWeight, path, node, false});
+        return;
+      }
+      if (rowMin > threshold)
+        return;
+      if (n.isEndOfWord && best == threshold)
+        level.push_back({n.weight, path, node, true});
+      stack.push_back({node, n.childMask, 0, best});
+      pathLens.push_back(path.size());
+    };
+
+    level.clear();
+    path.clear();
+    visit(root, 0, maxDistance + 1);
+    while (!stack.empty()) {
+      Frame &frame = stack.back();
+      if (!frame.mask) {
+        stack.pop_back();
+        pathLens.pop_back();
+        continue;
+      }
+
+      int index = lowestBit64(frame.mask);
+      NodeId child = arena.childAt(frame.node, frame.slot);
+      frame.mask &= frame.mask - 1;
+      ++frame.slot;
+      unsigned best = frame.best;
+
+      std::size_t depth = stack.size();
+      if (rows.size() < (depth + 1) * width)
+        rows.resize((depth + 1) * width);
+      const unsigned *prev = &rows[(depth - 1) * width];
+      unsigned *row = &rows[depth * width];
+      row[0] = static_cast<unsigned>(depth);
+      for (std::size_t j = 1; j < width; ++j) {
+        unsigned replace = prev[j - 1] + (query[j - 1] == index ? 0 : 1);
+        row[j] = std::min({replace, prev[j] + 1, row[j - 1] + 1});
+      }
+
+      path.resize(pathLens.back());
+      path += Alphabet::symbol(index);
+      visit(child, depth, best);
+    }
+
+    std::priority_queue<TopCandidate> queue(std::less<TopCandidate>(), std::move(level));
+    words.clear();
+    drainTop<Alphabet>(arena, queue, k - results.size(), words);
+    for (auto &word : words)
+      results.push_back({std::move(word), threshold});
+  }
+}
+
+/**
+ * @brief Считает слова с заданным префиксом.
+ * @param key Префикс.
+ * @return Количество слов.
+ */
+template <typename Alphabet>
+std::size_t BasicTrie<Alphabet>::countByKey(std::string_view key) const {
+  NodeId node = walkPrefix(key);
+  return node == NO_NODE ? 0 : arena.node(node).words;
+}
+
+/**
+ * @brief Место слова в отсортированном словаре.
+ * @details На каждом шаге спуска к ответу прибавляются слово в текущем
+ * узле (собственный префикс идёт раньше) и слова поддеревьев потомков
+ * с меньшим индексом символа.
+ * @param word Слово.
+ * @return Число слов словаря, идущих раньше word.
+ */
+template <typename Alphabet>
+std::size_t BasicTrie<Alphabet>::rankByKey(std::string_view word) const {
+  std::size_t rank = 0;
+  NodeId node = root;
+
+  for (size_t position = 0; position < word.size();) {
+    int index = Alphabet::nextIndex(word, position);
+    if (index == -1)
+      break;
+
+    const Node &n = arena.node(node);
+    rank += n.isEndOfWord;
+    int slot = n.slotOf(index);
+    for (int i = 0; i < slot; ++i)
+      rank += arena.node(arena.childAt(node, i)).words;
+
+    node = arena.getChild(node, index);
+    if (node == NO_NODE)
+      break;
+  }
+  return rank;
+}
+
+/**
+ * @brief Находит n-е слово с заданным префиксом.
+ * @details Спуск выбирает потомка, в поддерево которого попадает номер,
+ * вычитая счётчики пропущенных поддеревьев.
+ * @param key Префикс.
+ * @param n Номер слова (с нуля).
+ * @param word Найденное слово.
+ * @return false, если слов с префиксом не больше n.
+ */
+template <typename Alphabet>
+bool BasicTrie<Alphabet>::findNthByKey(std::string_view key, std::size_t n, std::string &word) const {
+  NodeId node = walkPrefix(key);
+  if (node == NO_NODE || n >= arena.node(node).words)
+    return false;
+
+  word = key;
+  while (true) {
+    const Node &current = arena.node(node);
+    if (current.isEndOfWord) {
+      if (n == 0)
+        return true;
+      --n;
+    }
+
+    int slot = 0;
+    for (std::uint64_t mask = current.childMask; mask; mask &= mask - 1, ++slot) {
+      NodeId child = arena.childAt(node, slot);
+      std::size_t words = arena.node(child).words;
+      if (n < words) {
+        word += Alphabet::symbol(lowestBit64(mask));
+        node = child;
+        break;
+      }
+      n -= words;
+    }
+  }
+}
+
+/**
+ * @brief Создаёт ленивый курсор по словам с указанным префиксом.
+ * @param key Префикс.
+ * @return Курсор по словам.
+ */
+template <typename Alphabet>
+BasicCompletionCursor<Alphabet> BasicTrie<Alphabet>::completions(std::string_view key) const {
+  return BasicCompletionCursor<Alphabet>(*this, key);
+}
+
+// === CompletionCursor ===
+
+/**
+ * @brief Конструктор. Спускается по префиксу и готовит стек обхода.
+ * @param trie Дерево.
+ * @param key Префикс.
+ */
+template <typename Alphabet>
+BasicCompletionCursor<Alphabet>::BasicCompletionCursor(const BasicTrie<Alphabet> &trie, std::string_view key) : trie(&trie) {
+  for (size_t position = 0; position < key.size();) {
+    int index = Alphabet::nextIndex(key, position);
+    if (index == -1)
+      return;
+    path += Alphabet::symbol(index);
+  }
+
+  NodeId node = trie.walkPrefix(key);
+  if (node == NO_NODE)
+    return;
+
+  const auto &n = trie.arena.node(node);
+  stack.push_back({node, n.childMask, 0, path.size(), n.isEndOfWord != 0});
+}
+
+/**
+ * @brief Выдаёт следующее слово.
+ * @param word Строка для результата.
+ * @return false, если слова закончились.
+ */
+template <typename Alphabet>
+bool BasicCompletionCursor<Alphabet>::next(std::string &word) {
+  while (!stack.empty()) {
+    Frame &top = stack.back();
+
+    if (top.pendingWord) {
+      top.pendingWord = false;
+      path.resize(top.pathLen);
+      word = path;
+      return true;
+    }
+
+    if (!top.mask) {
+      stack.pop_back();
+      continue;
+    }
+
+    int index = lowestBit64(top.mask);
+    NodeId child = trie->arena.childAt(top.node, top.slot);
+    top.mask &= top.mask - 1;
+    ++top.slot;
+
+    path.resize(top.pathLen);
+    path += Alphabet::symbol(index);
+
+    const auto &n = trie->arena.node(child);
+    stack.push_back({child, n.childMask, 0, path.size(), n.isEndOfWord != 0});
+  }
+  return false;
+}
+
+/**
+ * @brief Пропускает слова, не выдавая их.
+ * @param count Сколько слов пропустить.
+ */
+template <typename Alphabet>
+void BasicCompletionCursor<Alphabet>::skip(std::size_t count) {
+  while (count && !stack.empty()) {
+    Frame &top = stack.back();
+
+    if (top.pendingWord) {
+      top.pendingWord = false;
+      --count;
+      continue;
+    }
+
+    if (!top.mask) {
+      stack.pop_back();
+      continue;
+    }
+
+    int index = lowestBit64(top.mask);
+    NodeId child = trie->arena.childAt(top.node, top.slot);
+    top.mask &= top.mask - 1;
+    ++top.slot;
+
+    const auto &n = trie->arena.node(child);
+    if (n.words <= count) {
+      count -= n.words;
+      continue;
+    }
+
+    path.resize(top.pathLen);
+    path += Alphabet::symbol(index);
+    stack.push_back({child, n.childMask, 0, path.size(), n.isEndOfWord != 0});
+  }
+}
+
+/**
+ * @brief Выдаёт следующую страницу слов.
+ * @param count Размер страницы.
+ * @param page Вектор для результата.
+ * @return Количество выданных слов.
+ */
+template <typename Alphabet>
+std::size_t BasicCompletionCursor<Alphabet>::nextPage(std::size_t count, std::vector<std::string> &page) {
+  page.clear();
+  std::string word;
+  while (page.size() < count && next(word))
+    page.push_back(word);
+  return page.size();
+}
+
+template class BasicTrie<LatinAlphabet>;
+template class BasicTrie<RussianAlphabet>;
+template class BasicTrie<MixedAlphabet>;
+template class BasicTrie<UkrainianAlphabet>;
+
+template class BasicCompletionCursor<LatinAlphabet>;
+template class BasicCompletionCursor<RussianAlphabet>;
+template class BasicCompletionCursor<MixedAlphabet>;
+template class BasicCompletionCursor<UkrainianAlphabet>;
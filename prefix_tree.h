@@ -5,117 +5,314 @@
 
 #pragma once
 
+#include "alphabet.h"
+#include "dictionary.h"
+#include "node_arena.h"
+#include "prefix_cache.h"
+#include "t9_index.h"
+#include "utf8_text.h"
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
-#define ALPHABET_SIZE 59  ///< Размер алфавита (латиница + кириллица)
-#define ENG_SIZE 26       ///< Кол-во символов в английском алфавите
-#define RUS_SIZE 32       ///< Кол-во символов в русском алфавите
+template <typename Alphabet> class BasicCompletionCursor;
+struct SnapshotHeader;
 
 /**
- * @brief Глобальный алфавит для UTF-8 символов (a-z, а-я).
+ * @struct WordEntry
+ * @brief Слово с весом для пакетной загрузки.
  */
-const std::string alphabet[ALPHABET_SIZE] = {
-    "a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l", "m", "n", "o",
-    "p", "q", "r", "s", "t", "u", "v", "w", "x", "y", "z", "а", "б", "в", "г",
-    "д", "е", "ё", "ж", "з", "и", "й", "к", "л", "м", "н", "о", "п", "р", "с",
-    "т", "у", "ф", "х", "ц", "ч", "ш", "щ", "ъ", "ы", "ь", "э", "ю", "я"};
+struct WordEntry {
+  std::string word;     ///< Слово
+  std::uint32_t weight; ///< Вес (частота)
+};
 
 /**
- * @struct TrieNode
- * @brief Узел дерева Trie.
+ * @struct WordListStats
+ * @brief Итог загрузки списка слов.
  */
-struct TrieNode {
-  TrieNode *children[ALPHABET_SIZE]; ///< Указатели на дочерние узлы
-  bool isEndOfWord;                  ///< Признак конца слова
+struct WordListStats {
+  std::size_t words = 0;         ///< Принято слов
+  std::size_t rejected = 0;      ///< Отклонено строк (не UTF-8, буквы не из алфавита или неверный вес)
+  std::size_t firstRejected = 0; ///< Номер первой отклонённой строки (с 1; 0 — таких нет)
+};
 
-  /**
-   * @brief Конструктор по умолчанию.
-   */
-  TrieNode() {
-    isEndOfWord = false;
-    for (int i = 0; i < ALPHABET_SIZE; ++i)
-      children[i] = nullptr;
-  }
+/**
+ * @struct TrieShape
+ * @brief Форма дерева: размеры и распределение по глубинам.
+ */
+struct TrieShape {
+  std::size_t nodes = 0;                  ///< Узлов, достижимых из корня
+  std::size_t words = 0;                  ///< Слов
+  std::size_t bytes = 0;                  ///< Память арены
+  ArenaUsage arena{};                     ///< Занятые и свободные слоты арены
+  std::vector<std::size_t> nodesByDepth;  ///< Узлов на глубине (индекс — глубина)
+  std::vector<std::size_t> wordsByDepth;  ///< Слов длины (индекс — число символов)
 };
 
 /**
- * @class Trie
+ * @brief Наибольшее расстояние редактирования нечёткого поиска.
+ */
+constexpr unsigned MAX_FUZZY_DISTANCE = 2;
+
+/**
+ * @struct FuzzyMatch
+ * @brief Слово, найденное нечётким поиском.
+ */
+struct FuzzyMatch {
+  std::string word;   ///< Слово
+  unsigned distance;  ///< Расстояние от запроса до ближайшего префикса слова
+};
+
+/**
+ * @class BasicTrie
  * @brief Класс, реализующий префиксное дерево для поиска и автодополнения слов.
+ *
+ * @details Алфавит задаётся параметром шаблона: от него зависят тип маски
+ * (а значит, и размер) узла и таблица декодирования символов. Реализация
+ * инстанцируется явно для LatinAlphabet, RussianAlphabet, MixedAlphabet и
+ * UkrainianAlphabet. Остальные структуры проекта работают с деревом
+ * алфавита сборки — Trie.
+ *
+ * @tparam Alphabet Алфавит (BasicAlphabet)
  */
-class Trie {
+template <typename Alphabet> class BasicTrie : public Dictionary {
+  template <typename> friend class BasicCompletionCursor;
+  friend class DoubleArrayTrie;
+  friend class LoudsTrie;
+  friend class TypingSession;
+
+public:
+  using Node = BasicTrieNode<typename Alphabet::Mask>; ///< Узел дерева
+  using Arena = BasicNodeArena<Node>;                  ///< Арена узлов
+
 private:
-  TrieNode *root; ///< Корневой узел дерева
+  Arena arena;     ///< Арена, владеющая всеми узлами дерева
+  NodeId root;     ///< Индекс корневого узла
+  mutable std::unique_ptr<T9Index> keypad; ///< Индекс T9 (строится при первом запросе)
+  std::unique_ptr<PrefixCache> cache;      ///< Кэш ответов findAllByKey (если включён)
+
+  /**
+   * @brief Пересчитывает наибольший вес и число слов поддерева узла по его потомкам.
+   * @param node Индекс узла
+   * @return true, если хотя бы одно значение изменилось
+   */
+  bool refreshSubtree(NodeId node);
 
   /**
-   * @brief Рекурсивно удаляет поддерево.
-   * @param node Указатель на текущий узел
+   * @brief Строит поддеревья групп параллельно и подвешивает их под корень.
+   * @tparam Entry WordEntry или const WordEntry *
+   * @param buckets Группы допустимых слов по индексу первого символа
+   * (Alphabet::SIZE штук)
+   * @param threads Число потоков (0 — по числу ядер)
    */
-  void deleteSubTrie(TrieNode *node) {
-    if (!node)
-      return;
-    for (int i = 0; i < ALPHABET_SIZE; ++i)
-      deleteSubTrie(node->children[i]);
-    delete node;
-  }
+  template <typename Entry>
+  void insertBuckets(const std::vector<Entry> *buckets, unsigned threads);
 
   /**
-   * @brief Получает длину UTF-8 символа.
-   * @param ch Первый байт символа
-   * @return Количество байт в символе
+   * @brief Спускается от корня по префиксу.
+   * @param key Префикс
+   * @return Индекс узла, соответствующего префиксу, или NO_NODE
    */
-  std::size_t getUtf8CharLen(unsigned char ch) const;
+  NodeId walkPrefix(std::string_view key) const;
+
+  /**
+   * @brief Находит k самых тяжёлых слов поддерева узла.
+   * @param node Узел префикса
+   * @param prefix Путь до узла
+   * @param k Наибольшее число результатов
+   * @param results Вектор найденных слов (по убыванию веса)
+   */
+  void collectTop(NodeId node, std::string_view prefix, std::size_t k,
+                  std::vector<std::string> &results) const;
+
+  /**
+   * @brief Рекурсивно добавляет слова поддерева в индекс T9.
+   * @param node Текущий узел
+   * @param path Буфер пути до узла
+   * @param index Заполняемый индекс
+   */
+  void collectKeypad(NodeId node, std::string &path, T9Index &index) const;
+
+  /**
+   * @brief Заполняет заголовок снимка по текущему дереву.
+   * @param header Заголовок
+   */
+  void fillSnapshotHeader(SnapshotHeader &header) const;
 
 public:
   /**
    * @brief Конструктор. Создаёт пустое дерево.
    */
-  Trie() { root = new TrieNode; }
+  BasicTrie() { root = arena.allocNode(); }
 
   /**
-   * @brief Деструктор. Очищает все узлы дерева.
+   * @brief Деструктор. Узлы освобождаются вместе с ареной за O(1) по числу узлов.
    */
-  ~Trie() { deleteSubTrie(root); }
+  ~BasicTrie() = default;
+
+  BasicTrie(const BasicTrie &) = delete;
+  BasicTrie &operator=(const BasicTrie &) = delete;
 
   // === Getters ===
 
   /**
    * @brief Получает индекс символа в алфавите.
-   * @param ch UTF-8 символ
+   * @param ch UTF-8 символ (учитывается первый символ строки)
    * @return Индекс или -1, если символ не найден
    */
-  int getCharIndex(const std::string &ch) const;
+  int getCharIndex(std::string_view ch) const;
 
   /**
-   * @brief Возвращает указатель на корневой узел дерева.
-   * @return Указатель на TrieNode
+   * @brief Возвращает индекс корневого узла дерева.
+   * @return Индекс корня в арене
    */
-  TrieNode *getRoot();
+  NodeId getRoot() const;
 
   // === Utilities ===
 
+  /**
+   * @brief Проверяет, что слово непустое и состоит только из символов алфавита.
+   * @param word Слово UTF-8
+   * @return true, если слово можно вставить целиком
+   */
+  bool isValidWord(std::string_view word) const;
+
   /**
    * @brief Проверяет, является ли узел листом.
-   * @param node Указатель на узел
+   * @param node Индекс узла
    * @return true, если узел не имеет потомков
    */
-  bool isLeaf(TrieNode *node) const;
+  bool isLeaf(NodeId node) const;
+
+  /**
+   * @brief Печатает число узлов, слов и занимаемую деревом память.
+   * @details Память считается по вместимости массивов арены (узлы и пул
+   * ссылок, включая свободные блоки).
+   */
+  void printMemoryUsage() const;
+
+  /**
+   * @brief Заполненность арены: занятые и освобождённые узлы и ссылки.
+   * @return Счётчики арены
+   */
+  ArenaUsage nodeUsage() const;
+
+  /**
+   * @brief Форма дерева: число узлов и слов, память, распределение по
+   * глубинам.
+   * @details Обходит всё дерево.
+   * @return Форма дерева
+   */
+  TrieShape shape() const;
 
   // === Setters ===
 
   /**
    * @brief Вставляет слово в дерево.
+   * @details Повторная вставка существующего слова заменяет его вес. Слово
+   * с символами не из алфавита отвергается целиком, дерево не меняется.
+   * Регистр не приводится: входные данные нормализуются заранее
+   * (normalizeText).
    * @param word Слово для добавления
+   * @param weight Вес слова (частота), по умолчанию 1
+   * @return false, если слово пустое или содержит символы не из алфавита
    */
-  void insert(const std::string &word);
+  bool insert(std::string_view word, std::uint32_t weight = 1);
 
   /**
-   * @brief Удаляет слово из дерева (рекурсивно).
-   * @param node Текущий узел
+   * @brief Удаляет слово из дерева.
+   * @details Узлы, которые после удаления не ведут ни к одному слову,
+   * освобождаются. Для удаления всего слова передаются корень и позиция 0;
+   * иначе префикс word[0, position) должен вести в node. Счётчики и
+   * максимумы весов предков node тоже пересчитываются.
+   * @param node Узел, в который ведёт префикс word[0, position)
    * @param word Удаляемое слово
-   * @param position Позиция в слове
+   * @param position Позиция в слове, соответствующая узлу node
+   * @return true, если слово было в дереве и удалено
+   */
+  bool delWord(NodeId node, std::string_view word, std::size_t position);
+
+  /**
+   * @brief Перестраивает дерево в арене подряд в порядке обхода в глубину.
+   * @details Освобождённые удалением слоты исчезают, узлы одного слова
+   * оказываются рядом в памяти. Индексы узлов, курсоры и сессии ввода,
+   * полученные до вызова, становятся недействительными; индекс клавиатуры
+   * хранит слова и не меняется.
+   */
+  void compact();
+
+  // === Bulk loading ===
+
+  /**
+   * @brief Пакетно вставляет слова, строя поддеревья параллельно.
+   *
+   * @details Слова делятся по первому символу на независимые группы. Каждая
+   * группа строится в отдельном дереве на пуле потоков, затем готовое
+   * поддерево переносится в арену и подвешивается под корень. Группы, для
+   * первого символа которых у корня уже есть потомок, вставляются обычным
+   * insert. Слова с символами не из алфавита пропускаются.
+   *
+   * @param words Слова с весами
+   * @param threads Число потоков (0 — по числу ядер)
+   */
+  void bulkInsert(const std::vector<WordEntry> &words, unsigned threads = 0);
+
+  /**
+   * @brief Загружает слова из текстового файла UTF-8.
+   * @details Формат строки: "слово" или "слово<пробел|таб>частота". Пустые
+   * строки пропускаются, вес по умолчанию 1. Файл читается блоками,
+   * каждый блок целых строк проверяется как UTF-8 и нормализуется одним
+   * проходом (normalizeText), слова сразу раскладываются по группам
+   * bulkInsert. Строки с некорректным UTF-8, буквами не из алфавита или
+   * неверной частотой в дерево не попадают и учитываются в итоге.
+   * @param path Путь к файлу
+   * @param threads Число потоков (0 — по числу ядер)
+   * @param normalize Параметры нормализации
+   * @return Число принятых и отклонённых слов
+   * @throws WordListException если файл не удалось открыть
+   */
+  WordListStats loadWordList(const std::string &path, unsigned threads = 0,
+                             const NormalizeOptions &normalize = {});
+
+  // === Snapshots ===
+
+  /**
+   * @brief Сохраняет дерево в плоский двоичный снимок (см. trie_snapshot.h).
+   * @details Файл пишется во временный и атомарно переименовывается.
+   * @param path Путь к файлу
+   * @throws SnapshotException если файл не удалось записать
+   */
+  void save(const std::string &path) const;
+
+  /**
+   * @brief Собирает снимок дерева в памяти (тот же формат, что у save).
+   * @details Сборка — это копирование арены. Запись готового образа в
+   * файл (writeFileAtomically) дерева уже не касается и может идти в
+   * другом потоке, пока дерево меняется.
+   * @param image Буфер снимка (перезаписывается)
+   */
+  void saveImage(std::vector<char> &image) const;
+
+  /**
+   * @brief Загружает дерево из снимка.
+   * @details Файл отображается в память только для чтения, и поиск идёт
+   * прямо по нему. Первое изменение дерева копирует данные в память
+   * процесса. Текущее содержимое дерева заменяется.
+   * @param path Путь к файлу
+   * @param verify Проверять контрольную сумму данных
+   * @throws SnapshotException если файл отсутствует, обрезан, повреждён
+   * или записан другой версией формата
+   */
+  void load(const std::string &path, bool verify = true);
+
+  /**
+   * @brief Проверяет, читается ли дерево прямо из отображённого снимка.
+   * @return true, если дерево ещё не изменялось после load
    */
-  void delWord(TrieNode *node, const std::string &word, int position);
+  bool isMapped() const { return arena.isMapped(); }
 
   // === Printing ===
 
@@ -124,7 +321,7 @@ public:
    * @param node Узел, с которого начинается вывод
    * @param outString Собранное слово
    */
-  void printTrieRecur(TrieNode *node, std::string outString);
+  void printTrieRecur(NodeId node, std::string outString);
 
   /**
    * @brief Печатает все слова, сохранённые в Trie.
@@ -140,30 +337,211 @@ public:
    * @param position Позиция в слове
    * @return true, если слово найдено
    */
-  bool findKeyWord(TrieNode *node, const std::string &key, size_t position) const;
+  bool findKeyWord(NodeId node, std::string_view key, size_t position) const;
 
   /**
    * @brief Находит все слова с заданным префиксом.
    * @param node Текущий узел
    * @param key Префикс
    * @param position Текущая позиция в префиксе
-   * @param outString Собранное слово
+   * @param outString Буфер собранного слова (восстанавливается после вызова)
    * @param results Список результатов
+   * @return Число пройденных узлов
    */
-  void findAllWords(TrieNode *node, const std::string &key, size_t position,
-                    std::string outString, std::vector<std::string> &results) const;
+  std::size_t findAllWords(NodeId node, std::string_view key, size_t position,
+                    std::string &outString, std::vector<std::string> &results) const;
 
   /**
    * @brief Проверяет, есть ли полное совпадение по ключу.
    * @param key Искомое слово
    * @return true, если слово найдено
    */
-  bool findOneByKey(const std::string &key) const;
+  bool findOneByKey(std::string_view key) const override;
+
+  /**
+   * @brief Возвращает вес слова.
+   * @param key Искомое слово
+   * @return Вес слова или 0, если слова нет в дереве
+   */
+  std::uint32_t getWeight(std::string_view key) const;
+
+  /**
+   * @brief Находит k слов с наибольшим весом среди слов с указанным префиксом.
+   *
+   * @details Поиск "лучший-первым" по кэшированным в узлах максимумам весов:
+   * раскрываются только поддеревья, которые могут дать слово тяжелее уже
+   * найденных, поэтому стоимость зависит от k, а не от размера поддерева.
+   * Слова с равным весом упорядочиваются по возрастанию.
+   *
+   * @param key Префикс
+   * @param k Наибольшее число результатов
+   * @param results Вектор найденных слов (по убыванию веса)
+   */
+  void findTopByKey(std::string_view key, std::size_t k,
+                    std::vector<std::string> &results) const;
 
   /**
    * @brief Находит все слова, начинающиеся с указанного префикса.
    * @param key Префикс
    * @param results Вектор найденных слов
    */
-  void findAllByKey(const std::string &key, std::vector<std::string> &results) const;
+  void findAllByKey(std::string_view key, std::vector<std::string> &results) const override;
+
+  /**
+   * @brief Включает кэш ответов findAllByKey.
+   * @details Ответы кэшируются по префиксу. insert нового слова и delWord
+   * сбрасывают только записи префиксов изменённого слова; пакетная загрузка
+   * и загрузка снимка сбрасывают кэш целиком.
+   * @param bytes Предел памяти кэша (0 — выключить)
+   */
+  void enableCache(std::size_t bytes);
+
+  /**
+   * @brief Кэш ответов findAllByKey.
+   * @return Указатель на кэш или nullptr, если он выключен
+   */
+  const PrefixCache *prefixCache() const { return cache.get(); }
+
+  /**
+   * @brief Находит слова, набираемые последовательностью цифр клавиатуры.
+   * @details При первом вызове строит индекс T9 по всему словарю, далее
+   * индекс поддерживается при insert и delWord. Метод не потокобезопасен
+   * до построения индекса.
+   * @param digits Цифры 2..9
+   * @param k Наибольшее число результатов
+   * @param results Вектор найденных слов (по убыванию веса)
+   */
+  void findByDigits(std::string_view digits, std::size_t k,
+                    std::vector<std::string> &results) const;
+
+  /**
+   * @brief Находит продолжения префикса, набранного с опечатками.
+   *
+   * @details Дерево обходится в глубину со строкой таблицы Левенштейна на
+   * каждом уровне. Ветка отсекается, как только все значения строки
+   * превышают maxDistance. Если ни один потомок уже не может стать ближе к
+   * запросу, поддерево берётся целиком без спуска. Расстояние слова —
+   * наименьшее расстояние от запроса до его префиксов. Результаты идут по
+   * возрастанию расстояния, при равном — по убыванию веса.
+   *
+   * @param key Префикс (символы вне алфавита считаются несовпадающими)
+   * @param maxDistance Допустимое расстояние (не больше MAX_FUZZY_DISTANCE)
+   * @param k Наибольшее число результатов
+   * @param results Вектор найденных слов
+   */
+  void findFuzzyByKey(std::string_view key, unsigned maxDistance, std::size_t k,
+                      std::vector<FuzzyMatch> &results) const;
+
+  /**
+   * @brief Считает слова с указанным префиксом.
+   * @details Число слов хранится в каждом узле, поэтому стоимость равна
+   * длине префикса.
+   * @param key Префикс
+   * @return Количество слов
+   */
+  std::size_t countByKey(std::string_view key) const;
+
+  /**
+   * @brief Место слова в отсортированном словаре.
+   * @details Порядок — как у findAllByKey. Слово может и отсутствовать:
+   * тогда возвращается место, на котором оно стояло бы.
+   * @param word Слово
+   * @return Число слов словаря, идущих раньше word
+   */
+  std::size_t rankByKey(std::string_view word) const;
+
+  /**
+   * @brief Находит n-е (с нуля) слово с указанным префиксом.
+   * @param key Префикс
+   * @param n Номер слова в порядке findAllByKey
+   * @param word Найденное слово
+   * @return false, если слов с префиксом не больше n
+   */
+  bool findNthByKey(std::string_view key, std::size_t n, std::string &word) const;
+
+  /**
+   * @brief Создаёт ленивый курсор по словам с указанным префиксом.
+   * @param key Префикс
+   * @return Курсор, выдающий слова в том же порядке, что и findAllByKey
+   */
+  BasicCompletionCursor<Alphabet> completions(std::string_view key) const;
+};
+
+/**
+ * @brief Префиксное дерево алфавита сборки.
+ */
+using Trie = BasicTrie<DefaultAlphabet>;
+
+/**
+ * @class BasicCompletionCursor
+ * @brief Возобновляемый обход слов с заданным префиксом.
+ *
+ * @details Курсор хранит явный стек обхода в глубину и один буфер пути,
+ * поэтому выдаёт слова по запросу, не собирая весь результат и не
+ * копируя строки на каждом уровне. Память ограничена глубиной дерева и
+ * размером запрошенной страницы. Курсор становится недействительным после
+ * любого изменения дерева.
+ *
+ * @tparam Alphabet Алфавит дерева
+ */
+template <typename Alphabet> class BasicCompletionCursor {
+private:
+  /**
+   * @struct Frame
+   * @brief Состояние обхода одного узла.
+   */
+  struct Frame {
+    NodeId node;          ///< Индекс узла
+    std::uint64_t mask;   ///< Ещё не пройденные потомки
+    int slot;             ///< Позиция следующего потомка в блоке
+    std::size_t pathLen;  ///< Длина пути до узла включительно
+    bool pendingWord;     ///< Слово в самом узле ещё не выдано
+  };
+
+  const BasicTrie<Alphabet> *trie; ///< Обходимое дерево
+  std::vector<Frame> stack;  ///< Стек обхода
+  std::string path;          ///< Общий буфер текущего пути
+
+public:
+  /**
+   * @brief Конструктор.
+   * @param trie Дерево
+   * @param key Префикс
+   */
+  BasicCompletionCursor(const BasicTrie<Alphabet> &trie, std::string_view key);
+
+  /**
+   * @brief Выдаёт следующее слово.
+   * @param word Строка для результата
+   * @return false, если слова закончились
+   */
+  bool next(std::string &word);
+
+  /**
+   * @brief Выдаёт следующую страницу слов.
+   * @param count Размер страницы
+   * @param page Вектор для результата (очищается)
+   * @return Количество выданных слов (меньше count — слова закончились)
+   */
+  std::size_t nextPage(std::size_t count, std::vector<std::string> &page);
+
+  /**
+   * @brief Пропускает слова, не выдавая их.
+   * @details Поддеревья, целиком попадающие в пропуск, обходятся по
+   * счётчикам слов без спуска, поэтому переход к странице N стоит
+   * O(глубина * размер алфавита), а не O(N * размер страницы).
+   * @param count Сколько слов пропустить
+   */
+  void skip(std::size_t count);
+
+  /**
+   * @brief Проверяет, закончились ли слова.
+   * @return true, если больше слов нет
+   */
+  bool done() const { return stack.empty(); }
 };
+
+/**
+ * @brief Курсор по дереву алфавита сборки.
+ */
+using CompletionCursor = BasicCompletionCursor<DefaultAlphabet>;
@@ -0,0 +1,491 @@
+/**
+ * @file radix_trie.cpp
+ * @brief Реализация сжатого префиксного дерева (radix trie).
+ */
+
+#include "radix_trie.h"
+#include "my_exception.h"
+#include <algorithm>
+#include <iostream>
+#include <queue>
+
+// === Utilities ===
+
+/**
+ * @brief Добавляет метку в пул.
+ * @param chars Индексы символов.
+ * @param count Число символов.
+ * @return Смещение метки в пуле.
+ */
+std::uint32_t RadixTrie::appendLabel(const std::uint8_t *chars, std::size_t count) {
+  std::uint32_t offset = static_cast<std::uint32_t>(labels.size());
+  labels.insert(labels.end(), chars, chars + count);
+  return offset;
+}
+
+/**
+ * @brief Переписывает пул меток, оставляя только метки живых узлов.
+ * @details Узлы обходятся в глубину от корня; метка первого потомка
+ * ложится сразу за меткой родителя, как после расщепления, поэтому
+ * последующие склейки чаще обходятся без копирования.
+ */
+void RadixTrie::compactLabels() {
+  std::vector<std::uint8_t> pool;
+  pool.reserve(liveLabels);
+
+  std::vector<NodeId> stack{root};
+  while (!stack.empty()) {
+    NodeId node = stack.back();
+    stack.pop_back();
+
+    RadixNode &n = arena.node(node);
+    std::uint32_t offset = static_cast<std::uint32_t>(pool.size());
+    pool.insert(pool.end(), labels.begin() + n.labelOffset,
+                labels.begin() + n.labelOffset + n.labelLength);
+    n.labelOffset = offset;
+
+    for (int i = n.childCount(); i-- > 0;)
+      stack.push_back(arena.childAt(node, i));
+  }
+  labels.swap(pool);
+}
+
+/**
+ * @brief Уплотняет пул меток, если мёртвых символов в нём больше, чем живых.
+ */
+void RadixTrie::maybeCompactLabels() {
+  // Нижний порог не даёт переписывать маленький пул на каждом изменении.
+  if (labels.size() > 4096 && labels.size() - liveLabels > liveLabels)
+    compactLabels();
+}
+
+/**
+ * @brief Перестраивает арену и пул меток.
+ */
+void RadixTrie::compact() {
+  root = arena.compact(root);
+  compactLabels();
+}
+
+/**
+ * @brief Дописывает метку узла к строке.
+ * @param node Индекс узла.
+ * @param from Первый символ метки, с которого писать.
+ * @param out Строка-результат.
+ */
+void RadixTrie::appendLabelText(NodeId node, std::uint32_t from, std::string &out) const {
+  const RadixNode &n = arena.node(node);
+  for (std::uint32_t i = from; i < n.labelLength; ++i)
+    out += DefaultAlphabet::symbol(labels[n.labelOffset + i]);
+}
+
+/**
+ * @brief Пересчитывает наибольший вес поддерева узла по его потомкам.
+ * @param node Индекс узла.
+ */
+void RadixTrie::refreshMaxWeight(NodeId node) {
+  const RadixNode &n = arena.node(node);
+  std::uint32_t best = n.isEndOfWord ? n.weight : 0;
+
+  for (int i = 0; i < n.childCount(); ++i)
+    best = std::max(best, arena.node(arena.childAt(node, i)).maxWeight);
+
+  arena.node(node).maxWeight = best;
+}
+
+/**
+ * @brief Склеивает узел без слова с его единственным потомком.
+ * @details Узел сохраняет свой индекс (на него ссылается родитель) и
+ * забирает у потомка блок детей, вес и признак конца слова. Если метки
+ * лежат в пуле подряд (частый случай после расщепления), новая метка
+ * не копируется.
+ * @param node Индекс узла.
+ */
+void RadixTrie::mergeWithChild(NodeId node) {
+  NodeId only = arena.childAt(node, 0);
+  arena.removeChild(node, lowestBit64(arena.node(node).childMask));
+
+  RadixNode merged = arena.node(only);
+  const RadixNode &head = arena.node(node);
+  if (head.labelOffset + head.labelLength == merged.labelOffset) {
+    merged.labelOffset = head.labelOffset;
+  } else {
+    std::vector<std::uint8_t> text(labels.begin() + head.labelOffset,
+                                   labels.begin() + head.labelOffset + head.labelLength);
+    text.insert(text.end(), labels.begin() + merged.labelOffset,
+                labels.begin() + merged.labelOffset + merged.labelLength);
+    merged.labelOffset = appendLabel(text.data(), text.size());
+  }
+  merged.labelLength += head.labelLength;
+
+  arena.node(node) = merged;
+  arena.node(only).childMask = 0;
+  arena.freeNode(only);
+}
+
+/**
+ * @brief Находит узел, путь к которому начинается с префикса.
+ * @details Префикс может закончиться посередине метки: тогда consumed
+ * меньше длины метки найденного узла.
+ * @param key Префикс.
+ * @param node Найденный узел.
+ * @param consumed Сколько символов метки узла покрыто префиксом.
+ * @return false, если слов с таким префиксом нет.
+ */
+bool RadixTrie::locate(std::string_view key, NodeId &node, std::uint32_t &consumed) const {
+  node = root;
+  consumed = 0;
+
+  for (std::size_t position = 0; position < key.size();) {
+    int index = DefaultAlphabet::nextIndex(key, position);
+    if (index == -1)
+      return false;
+
+    const RadixNode &n = arena.node(node);
+    if (consumed < n.labelLength) {
+      if (labels[n.labelOffset + consumed] != index)
+        return false;
+      ++consumed;
+      continue;
+    }
+
+    node = arena.getChild(node, index);
+    if (node == NO_NODE)
+      return false;
+    consumed = 1;
+  }
+  return true;
+}
+
+/**
+ * @brief Рекурсивно собирает статистику по поддереву.
+ * @param node Текущий узел.
+ * @param words Счётчик слов.
+ */
+void RadixTrie::collectStats(NodeId node, std::size_t &words) const {
+  if (arena.node(node).isEndOfWord)
+    ++words;
+
+  for (int i = 0; i < arena.node(node).childCount(); ++i)
+    collectStats(arena.childAt(node, i), words);
+}
+
+/**
+ * @brief Печатает число узлов, слов и занимаемую деревом память.
+ */
+void RadixTrie::printMemoryUsage() const {
+  std::size_t words = 0;
+  collectStats(root, words);
+  std::size_t nodes = arena.liveNodes();
+  std::size_t bytes = arena.memoryUsage() + labels.capacity();
+
+  std::cout << "Узлов: " << nodes << ", слов: " << words << ", память: " << bytes
+            << " байт";
+  if (words)
+    std::cout << " (" << bytes / words << " байт на слово)";
+  std::cout << std::endl;
+}
+
+// === Setters ===
+
+/**
+ * @brief Вставляет слово в дерево.
+ *
+ * @details Если слово расходится с меткой ребра посередине, ребро
+ * расщепляется промежуточным узлом; остаток слова становится меткой
+ * нового листа. Максимумы весов на пути обновляются при спуске, а если
+ * вес существующего слова уменьшился, пересчитываются снизу вверх.
+ *
+ * @param word Слово для вставки.
+ * @param weight Вес слова.
+ * @return false, если слово пустое или содержит символы не из алфавита.
+ */
+bool RadixTrie::insert(std::string_view word, std::uint32_t weight) {
+  if (word.empty())
+    return false;
+
+  std::vector<std::uint8_t> chars;
+  chars.reserve(word.size());
+  for (std::size_t position = 0; position < word.size();) {
+    int index = DefaultAlphabet::nextIndex(word, position);
+    if (index == -1)
+      return false;
+    chars.push_back(static_cast<std::uint8_t>(index));
+  }
+
+  std::vector<NodeId> path;
+  NodeId node = root;
+  std::size_t i = 0;
+
+  while (true) {
+    path.push_back(node);
+    arena.node(node).maxWeight = std::max(arena.node(node).maxWeight, weight);
+
+    if (i == chars.size())
+      break;
+
+    NodeId child = arena.getChild(node, chars[i]);
+    if (child == NO_NODE) {
+      NodeId leaf = arena.allocNode();
+      RadixNode &n = arena.node(leaf);
+      n.labelOffset = appendLabel(chars.data() + i, chars.size() - i);
+      n.labelLength = static_cast<std::uint32_t>(chars.size() - i);
+      liveLabels += n.labelLength;
+      n.isEndOfWord = true;
+      n.weight = weight;
+      n.maxWeight = weight;
+      arena.addChild(node, chars[i], leaf);
+      maybeCompactLabels();
+      return true;
+    }
+
+    const RadixNode &c = arena.node(child);
+    std::uint32_t common = 1;
+    while (common < c.labelLength && i + common < chars.size() &&
+           labels[c.labelOffset + common] == chars[i + common])
+      ++common;
+
+    if (common < c.labelLength) {
+      NodeId mid = arena.allocNode();
+      RadixNode &tail = arena.node(child);
+      RadixNode &head = arena.node(mid);
+      head.labelOffset = tail.labelOffset;
+      head.labelLength = common;
+      head.maxWeight = tail.maxWeight;
+      tail.labelOffset += common;
+      tail.labelLength -= common;
+
+      arena.setChild(node, chars[i], mid);
+      arena.addChild(mid, labels[arena.node(child).labelOffset], child);
+      child = mid;
+    }
+
+    i += common;
+    node = child;
+  }
+
+  RadixNode &last = arena.node(node);
+  bool lowered = last.isEndOfWord && weight < last.weight;
+  last.isEndOfWord = true;
+  last.weight = weight;
+
+  if (!lowered)
+    return true;
+
+  for (auto it = path.rbegin(); it != path.rend(); ++it)
+    refreshMaxWeight(*it);
+  return true;
+}
+
+/**
+ * @brief Рекурсивно удаляет слово из дерева.
+ * @details На обратном ходе рекурсии узел без слова и без потомков
+ * отсекается, а узел без слова с единственным потомком склеивается с ним.
+ * Начальный узел не отсекается и не склеивается.
+ * @param node Текущий узел (его метка уже пройдена).
+ * @param word Удаляемое слово.
+ * @param position Текущая позиция в строке.
+ * @return true, если слово было в дереве и удалено.
+ * @throws EmptyInputException если строка пустая.
+ */
+bool RadixTrie::delWord(NodeId node, std::string_view word, std::size_t position) {
+  if (word.empty())
+    throw EmptyInputException();
+
+  if (position >= word.size())
+    return false;
+
+  int index = DefaultAlphabet::nextIndex(word, position);
+  if (index == -1)
+    return false;
+
+  NodeId child = arena.getChild(node, index);
+  if (child == NO_NODE)
+    return false;
+
+  const RadixNode &c = arena.node(child);
+  for (std::uint32_t i = 1; i < c.labelLength; ++i) {
+    if (position >= word.size() || DefaultAlphabet::nextIndex(word, position) != labels[c.labelOffset + i])
+      return false;
+  }
+
+  if (position < word.size()) {
+    if (!delWord(child, word, position))
+      return false;
+  } else {
+    if (!c.isEndOfWord)
+      return false;
+    arena.node(child).isEndOfWord = false;
+    arena.node(child).weight = 0;
+  }
+
+  const RadixNode &after = arena.node(child);
+  if (!after.isEndOfWord && after.childMask == 0) {
+    liveLabels -= after.labelLength;
+    arena.removeChild(node, index);
+    arena.freeNode(child);
+  } else {
+    if (!after.isEndOfWord && after.childCount() == 1)
+      mergeWithChild(child);
+    refreshMaxWeight(child);
+  }
+  refreshMaxWeight(node);
+
+  // Рекурсивные вызовы получают потомков, корень — только внешний вызов.
+  if (node == root)
+    maybeCompactLabels();
+  return true;
+}
+
+// === Print ===
+
+/**
+ * @brief Печатает все слова, содержащиеся в дереве.
+ */
+void RadixTrie::printTrie() const {
+  std::vector<std::string> words;
+  std::string outString;
+  findAllWords(root, outString, words);
+
+  std::cout << std::endl;
+  for (const auto &word : words)
+    std::cout << word << "* ";
+  std::cout << std::endl;
+}
+
+// === Find ===
+
+/**
+ * @brief Поиск полного совпадения по ключу.
+ * @param node Узел, с которого начинается поиск (конец его метки).
+ * @param key Строка-ключ.
+ * @param position Текущая позиция.
+ * @return true, если слово найдено и оно конечное.
+ */
+bool RadixTrie::findKeyWord(NodeId node, std::string_view key, size_t position) const {
+  if (position >= key.size())
+    return false;
+
+  while (position < key.size()) {
+    int index = DefaultAlphabet::nextIndex(key, position);
+    if (index == -1)
+      return false;
+
+    node = arena.getChild(node, index);
+    if (node == NO_NODE)
+      return false;
+
+    const RadixNode &n = arena.node(node);
+    for (std::uint32_t i = 1; i < n.labelLength; ++i) {
+      if (position >= key.size() || DefaultAlphabet::nextIndex(key, position) != labels[n.labelOffset + i])
+        return false;
+    }
+  }
+
+  return arena.node(node).isEndOfWord;
+}
+
+/**
+ * @brief Рекурсивно собирает слова поддерева узла.
+ * @param node Текущий узел (его метка уже учтена в outString).
+ * @param outString Буфер собранной строки (восстанавливается после вызова).
+ * @param results Вектор результатов.
+ */
+void RadixTrie::findAllWords(NodeId node, std::string &outString,
+                             std::vector<std::string> &results) const {
+  if (arena.node(node).isEndOfWord)
+    results.push_back(outString);
+
+  std::size_t nodeLen = outString.size();
+  for (int slot = 0; slot < arena.node(node).childCount(); ++slot) {
+    NodeId child = arena.childAt(node, slot);
+    appendLabelText(child, 0, outString);
+    findAllWords(child, outString, results);
+    outString.resize(nodeLen);
+  }
+}
+
+/**
+ * @brief Проверяет наличие полного слова в дереве.
+ * @param key Слово для поиска.
+ * @return true, если слово найдено.
+ */
+bool RadixTrie::findOneByKey(std::string_view key) const {
+  return findKeyWord(root, key, 0);
+}
+
+/**
+ * @brief Находит все слова, начинающиеся с заданного префикса.
+ * @param key Префикс.
+ * @param results Вектор, куда помещаются найденные слова.
+ */
+void RadixTrie::findAllByKey(std::string_view key, std::vector<std::string> &results) const {
+  results.clear();
+  NodeId node;
+  std::uint32_t consumed;
+  if (!locate(key, node, consumed))
+    return;
+
+  std::string outString(key);
+  appendLabelText(node, consumed, outString);
+  findAllWords(node, outString, results);
+}
+
+/**
+ * @brief Находит k слов с наибольшим весом среди слов с заданным префиксом.
+ * @param key Префикс.
+ * @param k Наибольшее число результатов.
+ * @param results Вектор найденных слов.
+ */
+void RadixTrie::findTopByKey(std::string_view key, std::size_t k,
+                             std::vector<std::string> &results) const {
+  results.clear();
+  if (k == 0)
+    return;
+
+  NodeId node;
+  std::uint32_t consumed;
+  if (!locate(key, node, consumed))
+    return;
+
+  /// Кандидат очереди: поддерево (раскрыть) либо готовое слово (выдать).
+  struct Candidate {
+    std::uint32_t weight;
+    std::string word;
+    NodeId node;
+    bool isWord;
+
+    bool operator<(const Candidate &other) const {
+      if (weight != other.weight)
+        return weight < other.weight;
+      return word > other.word;
+    }
+  };
+
+  std::string start(key);
+  appendLabelText(node, consumed, start);
+
+  std::priority_queue<Candidate> queue;
+  queue.push({arena.node(node).maxWeight, std::move(start), node, false});
+
+  while (!queue.empty() && results.size() < k) {
+    Candidate top = queue.top();
+    queue.pop();
+
+    if (top.isWord) {
+      results.push_back(std::move(top.word));
+      continue;
+    }
+
+    const RadixNode &n = arena.node(top.node);
+    if (n.isEndOfWord)
+      queue.push({n.weight, top.word, top.node, true});
+
+    for (int slot = 0; slot < n.childCount(); ++slot) {
+      NodeId child = arena.childAt(top.node, slot);
+      std::string word = top.word;
+      appendLabelText(child, 0, word);
+      queue.push({arena.node(child).maxWeight, std::move(word), child, false});
+    }
+  }
+}
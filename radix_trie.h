@@ -0,0 +1,253 @@
+/**
+ * @file radix_trie.h
+ * @brief Сжатое префиксное дерево (radix/Patricia trie) с тем же API, что и Trie.
+ */
+
+#pragma once
+
+#include "alphabet.h"
+#include "node_arena.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @struct RadixNode
+ * @brief Узел сжатого дерева: ребро к узлу помечено цепочкой символов.
+ *
+ * @details Метка хранится как отрезок [labelOffset, labelOffset + labelLength)
+ * общего пула меток, в котором лежат индексы символов алфавита. Потомки
+ * адресуются, как в TrieNode, битовой маской по первому символу метки и
+ * плотным блоком в арене.
+ */
+struct RadixNode {
+  std::uint64_t childMask;   ///< Маска потомков по первому символу их меток
+  NodeId children;           ///< Смещение блока потомков в пуле ссылок
+  std::uint32_t labelOffset; ///< Начало метки ребра в пуле меток
+  std::uint32_t labelLength; ///< Длина метки в символах
+  std::uint32_t weight;      ///< Вес слова, оканчивающегося в узле
+  std::uint32_t maxWeight;   ///< Наибольший вес слова в поддереве узла
+  bool isEndOfWord;          ///< Признак конца слова
+
+  /**
+   * @brief Конструктор по умолчанию.
+   */
+  RadixNode()
+      : childMask(0), children(NO_NODE), labelOffset(0), labelLength(0), weight(0),
+        maxWeight(0), isEndOfWord(false) {}
+
+  /**
+   * @brief Количество потомков узла.
+   * @return Число установленных бит маски
+   */
+  int childCount() const { return popcount64(childMask); }
+
+  /**
+   * @brief Позиция потомка с заданным первым символом в плотном блоке.
+   * @param index Индекс символа в алфавите
+   * @return Смещение внутри блока
+   */
+  int slotOf(int index) const {
+    return popcount64(childMask & ((std::uint64_t(1) << index) - 1));
+  }
+
+  /**
+   * @brief Проверяет наличие потомка с заданным первым символом.
+   * @param index Индекс символа в алфавите
+   * @return true, если потомок есть
+   */
+  bool hasChild(int index) const { return childMask & (std::uint64_t(1) << index); }
+};
+
+/**
+ * @class RadixTrie
+ * @brief Префиксное дерево, в котором цепочки узлов с одним потомком
+ * сжаты в метки рёбер.
+ *
+ * @details Публичный интерфейс повторяет Trie. Вставка расщепляет ребро,
+ * если слово расходится с меткой посередине; удаление отсекает узлы без
+ * слов и склеивает узел с единственным потомком обратно в одно ребро.
+ * Длинные слова проходятся за несколько переходов по узлам вместо одного
+ * перехода на символ.
+ *
+ * Метки только дописываются в пул: расщепление делит метку на месте, а
+ * склейка несмежных меток и удаление листа оставляют в пуле мёртвые
+ * символы. Когда мёртвых становится больше, чем живых, пул переписывается
+ * (compactLabels), так что он не больше чем вдвое превышает сумму длин
+ * живых меток. compact() дополнительно уплотняет арену узлов.
+ */
+class RadixTrie {
+private:
+  BasicNodeArena<RadixNode> arena;   ///< Арена узлов
+  std::vector<std::uint8_t> labels;  ///< Пул меток (индексы символов)
+  std::size_t liveLabels = 0;        ///< Символов пула, на которые ссылаются живые узлы
+  NodeId root;                       ///< Индекс корня (метка пустая)
+
+  /**
+   * @brief Добавляет метку в пул.
+   * @param chars Индексы символов
+   * @param count Число символов
+   * @return Смещение метки в пуле
+   */
+  std::uint32_t appendLabel(const std::uint8_t *chars, std::size_t count);
+
+  /**
+   * @brief Переписывает пул меток, оставляя только метки живых узлов.
+   * @details Узлы обходятся по порядку индексов; индексы узлов не меняются.
+   */
+  void compactLabels();
+
+  /**
+   * @brief Уплотняет пул меток, если мёртвых символов в нём больше, чем живых.
+   */
+  void maybeCompactLabels();
+
+  /**
+   * @brief Дописывает метку узла к строке.
+   * @param node Индекс узла
+   * @param from Первый символ метки, с которого писать
+   * @param out Строка-результат
+   */
+  void appendLabelText(NodeId node, std::uint32_t from, std::string &out) const;
+
+  /**
+   * @brief Пересчитывает наибольший вес поддерева узла.
+   * @param node Индекс узла
+   */
+  void refreshMaxWeight(NodeId node);
+
+  /**
+   * @brief Склеивает узел без слова с его единственным потомком.
+   * @param node Индекс узла
+   */
+  void mergeWithChild(NodeId node);
+
+  /**
+   * @brief Находит узел, путь к которому начинается с префикса.
+   * @param key Префикс
+   * @param node Найденный узел
+   * @param consumed Сколько символов метки узла покрыто префиксом
+   * @return false, если таких слов нет
+   */
+  bool locate(std::string_view key, NodeId &node, std::uint32_t &consumed) const;
+
+  /**
+   * @brief Рекурсивно собирает статистику по поддереву.
+   * @param node Текущий узел
+   * @param words Счётчик слов
+   */
+  void collectStats(NodeId node, std::size_t &words) const;
+
+public:
+  /**
+   * @brief Конструктор. Создаёт пустое дерево.
+   */
+  RadixTrie() { root = arena.allocNode(); }
+
+  RadixTrie(const RadixTrie &) = delete;
+  RadixTrie &operator=(const RadixTrie &) = delete;
+
+  // === Getters ===
+
+  /**
+   * @brief Возвращает индекс корневого узла дерева.
+   * @return Индекс корня в арене
+   */
+  NodeId getRoot() const { return root; }
+
+  // === Utilities ===
+
+  /**
+   * @brief Проверяет, является ли узел листом.
+   * @param node Индекс узла
+   * @return true, если у узла нет потомков
+   */
+  bool isLeaf(NodeId node) const { return arena.node(node).childMask == 0; }
+
+  /**
+   * @brief Печатает число узлов, слов и занимаемую деревом память.
+   */
+  void printMemoryUsage() const;
+
+  /**
+   * @brief Перестраивает арену подряд в порядке обхода в глубину и
+   * переписывает пул меток без неиспользуемых символов.
+   * @details Индексы узлов меняются: ранее полученные NodeId (в том числе
+   * корень) после вызова недействительны.
+   */
+  void compact();
+
+  // === Setters ===
+
+  /**
+   * @brief Вставляет слово в дерево.
+   * @details Пустое слово и слово с символом вне алфавита не вставляются,
+   * дерево не меняется. Повторная вставка существующего слова заменяет его
+   * вес.
+   * @param word Слово для добавления
+   * @param weight Вес слова (частота), по умолчанию 1
+   * @return false, если слово пустое или содержит символы не из алфавита
+   */
+  bool insert(std::string_view word, std::uint32_t weight = 1);
+
+  /**
+   * @brief Удаляет слово из поддерева узла.
+   * @param node Узел, от которого отсчитывается слово (обычно getRoot())
+   * @param word Удаляемое слово
+   * @param position Позиция в слове, соответствующая узлу
+   * @return true, если слово было в дереве и удалено
+   * @throws EmptyInputException если строка пустая
+   */
+  bool delWord(NodeId node, std::string_view word, std::size_t position);
+
+  // === Printing ===
+
+  /**
+   * @brief Печатает все слова, сохранённые в дереве.
+   */
+  void printTrie() const;
+
+  // === Searching ===
+
+  /**
+   * @brief Проверяет наличие полного слова в поддереве узла.
+   * @param node Узел, с которого начинается проверка (конец его метки)
+   * @param key Искомое слово
+   * @param position Позиция в слове
+   * @return true, если слово найдено
+   */
+  bool findKeyWord(NodeId node, std::string_view key, std::size_t position) const;
+
+  /**
+   * @brief Рекурсивно собирает слова поддерева узла.
+   * @param node Текущий узел (его метка уже учтена в outString)
+   * @param outString Буфер собранного слова (восстанавливается после вызова)
+   * @param results Список результатов
+   */
+  void findAllWords(NodeId node, std::string &outString,
+                    std::vector<std::string> &results) const;
+
+  /**
+   * @brief Проверяет, есть ли полное совпадение по ключу.
+   * @param key Искомое слово
+   * @return true, если слово найдено
+   */
+  bool findOneByKey(std::string_view key) const;
+
+  /**
+   * @brief Находит все слова, начинающиеся с указанного префикса.
+   * @param key Префикс
+   * @param results Вектор найденных слов (в порядке алфавита)
+   */
+  void findAllByKey(std::string_view key, std::vector<std::string> &results) const;
+
+  /**
+   * @brief Находит k слов с наибольшим весом среди слов с указанным префиксом.
+   * @param key Префикс
+   * @param k Наибольшее число результатов
+   * @param results Вектор найденных слов (по убыванию веса)
+   */
+  void findTopByKey(std::string_view key, std::size_t k,
+                    std::vector<std::string> &results) const;
+};
@@ -0,0 +1,161 @@
+/**
+ * @file sharded_trie.cpp
+ * @brief Реализация словаря из независимых деревьев Trie.
+ */
+
+#include "sharded_trie.h"
+#include <algorithm>
+#include <mutex>
+#include <utility>
+
+/**
+ * @brief Конструктор.
+ * @param count Число шардов (0 — по одному на букву алфавита).
+ */
+ShardedTrie::ShardedTrie(unsigned count) {
+  if (count == 0 || count > static_cast<unsigned>(DefaultAlphabet::SIZE))
+    count = DefaultAlphabet::SIZE;
+  shards.reserve(count);
+  for (unsigned i = 0; i < count; ++i)
+    shards.emplace_back(new Shard());
+}
+
+/**
+ * @brief Шард, которому принадлежит слово или префикс.
+ * @details Буквы делятся между шардами непрерывными диапазонами индексов.
+ * @param word Слово.
+ * @return Номер шарда или -1.
+ */
+int ShardedTrie::shardOf(std::string_view word) const {
+  std::size_t position = 0;
+  int index = DefaultAlphabet::nextIndex(word, position);
+  if (index == -1)
+    return -1;
+  return static_cast<int>(static_cast<std::size_t>(index) * shards.size() / DefaultAlphabet::SIZE);
+}
+
+/**
+ * @brief Вставляет слово в его шард.
+ * @param word Слово.
+ * @param weight Вес.
+ * @return false, если слово не принято.
+ */
+bool ShardedTrie::insert(std::string_view word, std::uint32_t weight) {
+  int shard = word.empty() ? -1 : shardOf(word);
+  if (shard == -1)
+    return false;
+  Shard &s = *shards[shard];
+  std::unique_lock<std::shared_mutex> lock(s.mutex);
+  return s.trie.insert(word, weight);
+}
+
+/**
+ * @brief Удаляет слово из его шарда.
+ * @param word Слово.
+ * @return true, если слово было и удалено.
+ */
+bool ShardedTrie::remove(std::string_view word) {
+  int shard = word.empty() ? -1 : shardOf(word);
+  if (shard == -1)
+    return false;
+  Shard &s = *shards[shard];
+  std::unique_lock<std::shared_mutex> lock(s.mutex);
+  return s.trie.delWord(s.trie.getRoot(), word, 0);
+}
+
+/**
+ * @brief Проверяет, есть ли слово в словаре.
+ * @param key Искомое слово.
+ * @return true, если слово найдено.
+ */
+bool ShardedTrie::findOneByKey(std::string_view key) const {
+  int shard = key.empty() ? -1 : shardOf(key);
+  if (shard == -1)
+    return false;
+  const Shard &s = *shards[shard];
+  std::shared_lock<std::shared_mutex> lock(s.mutex);
+  return s.trie.findOneByKey(key);
+}
+
+/**
+ * @brief Возвращает вес слова.
+ * @param key Искомое слово.
+ * @return Вес или 0.
+ */
+std::uint32_t ShardedTrie::getWeight(std::string_view key) const {
+  int shard = key.empty() ? -1 : shardOf(key);
+  if (shard == -1)
+    return 0;
+  const Shard &s = *shards[shard];
+  std::shared_lock<std::shared_mutex> lock(s.mutex);
+  return s.trie.getWeight(key);
+}
+
+/**
+ * @brief Находит все слова с префиксом.
+ * @param key Префикс.
+ * @param results Вектор найденных слов.
+ */
+void ShardedTrie::findAllByKey(std::string_view key, std::vector<std::string> &results) const {
+  results.clear();
+  if (!key.empty()) {
+    int shard = shardOf(key);
+    if (shard == -1)
+      return;
+    const Shard &s = *shards[shard];
+    std::shared_lock<std::shared_mutex> lock(s.mutex);
+    s.trie.findAllByKey(key, results);
+    return;
+  }
+
+  std::vector<std::string> part;
+  for (const auto &s : shards) {
+    {
+      std::shared_lock<std::shared_mutex> lock(s->mutex);
+      s->trie.findAllByKey(key, part);
+    }
+    results.insert(results.end(), std::make_move_iterator(part.begin()),
+                   std::make_move_iterator(part.end()));
+  }
+}
+
+/**
+ * @brief Находит k самых тяжёлых слов с префиксом.
+ * @param key Префикс.
+ * @param k Наибольшее число результатов.
+ * @param results Вектор найденных слов.
+ */
+void ShardedTrie::findTopByKey(std::string_view key, std::size_t k,
+                               std::vector<std::string> &results) const {
+  results.clear();
+  if (!key.empty()) {
+    int shard = shardOf(key);
+    if (shard == -1)
+      return;
+    const Shard &s = *shards[shard];
+    std::shared_lock<std::shared_mutex> lock(s.mutex);
+    s.trie.findTopByKey(key, k, results);
+    return;
+  }
+
+  // Вес берётся под той же блокировкой, что и слова шарда.
+  std::vector<std::pair<std::uint32_t, std::string>> candidates;
+  std::vector<std::string> part;
+  for (const auto &s : shards) {
+    std::shared_lock<std::shared_mutex> lock(s->mutex);
+    s->trie.findTopByKey(key, k, part);
+    for (std::string &word : part) {
+      std::uint32_t weight = s->trie.getWeight(word);
+      candidates.emplace_back(weight, std::move(word));
+    }
+  }
+
+  // Порядок как в Trie::findTopByKey: по убыванию веса, при равенстве — по возрастанию.
+  std::size_t count = std::min(k, candidates.size());
+  std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(),
+                    [](const auto &a, const auto &b) {
+                      return a.first != b.first ? a.first > b.first : a.second < b.second;
+                    });
+  for (std::size_t i = 0; i < count; ++i)
+    results.push_back(std::move(candidates[i].second));
+}
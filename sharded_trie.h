@@ -0,0 +1,114 @@
+/**
+ * @file sharded_trie.h
+ * @brief Словарь из независимых деревьев Trie с блокировкой на каждое.
+ */
+
+#pragma once
+
+#include "dictionary.h"
+#include "prefix_tree.h"
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class ShardedTrie
+ * @brief Словарь для многопоточной смешанной нагрузки: слова разложены по
+ * независимым деревьям (шардам) по первой букве.
+ *
+ * @details Каждый шард — отдельный Trie со своим std::shared_mutex:
+ * поиски в одном шарде идут параллельно, вставка и удаление блокируют
+ * только свой шард. Шард отвечает за непрерывный диапазон букв алфавита
+ * (а не за хэш), поэтому слова шардов, взятых по порядку, идут в порядке
+ * алфавита, и перечисление по пустому префиксу — простая склейка ответов
+ * шардов. Непустой префикс целиком лежит в одном шарде.
+ *
+ * Курсоры, сессии ввода и снимки работают с одним деревом и здесь не
+ * поддерживаются.
+ */
+class ShardedTrie : public Dictionary {
+private:
+  /**
+   * @struct Shard
+   * @brief Дерево с блокировкой (на отдельных строках кэша).
+   */
+  struct alignas(64) Shard {
+    mutable std::shared_mutex mutex; ///< Блокировка читателей и писателя
+    Trie trie;                       ///< Слова шарда
+  };
+
+  std::vector<std::unique_ptr<Shard>> shards; ///< Шарды по возрастанию букв
+
+  /**
+   * @brief Шард, которому принадлежит слово или префикс.
+   * @param word Слово (непустое)
+   * @return Номер шарда или -1, если первая буква не из алфавита
+   */
+  int shardOf(std::string_view word) const;
+
+public:
+  /**
+   * @brief Конструктор.
+   * @param count Число шардов (0 — по одному на букву алфавита; больше
+   * числа букв не бывает)
+   */
+  explicit ShardedTrie(unsigned count = 0);
+
+  /**
+   * @brief Число шардов.
+   * @return Количество
+   */
+  std::size_t shardCount() const { return shards.size(); }
+
+  /**
+   * @brief Вставляет слово (как Trie::insert).
+   * @param word Слово
+   * @param weight Вес
+   * @return false, если слово пустое или содержит символы не из алфавита
+   */
+  bool insert(std::string_view word, std::uint32_t weight = 1);
+
+  /**
+   * @brief Удаляет слово (как Trie::delWord от корня).
+   * @param word Слово
+   * @return true, если слово было и удалено
+   */
+  bool remove(std::string_view word);
+
+  /**
+   * @brief Проверяет, есть ли слово в словаре.
+   * @param key Искомое слово
+   * @return true, если слово найдено
+   */
+  bool findOneByKey(std::string_view key) const override;
+
+  /**
+   * @brief Возвращает вес слова.
+   * @param key Искомое слово
+   * @return Вес или 0, если слова нет
+   */
+  std::uint32_t getWeight(std::string_view key) const;
+
+  /**
+   * @brief Находит все слова с префиксом в порядке алфавита.
+   * @details Пустой префикс обходит шарды по очереди, каждый под своей
+   * блокировкой чтения: ответ согласован внутри шарда, но не между ними.
+   * @param key Префикс
+   * @param results Вектор найденных слов
+   */
+  void findAllByKey(std::string_view key, std::vector<std::string> &results) const override;
+
+  /**
+   * @brief Находит k самых тяжёлых слов с префиксом (порядок как у
+   * Trie::findTopByKey).
+   * @details Для пустого префикса лучшие k каждого шарда сливаются по
+   * убыванию веса.
+   * @param key Префикс
+   * @param k Наибольшее число результатов
+   * @param results Вектор найденных слов
+   */
+  void findTopByKey(std::string_view key, std::size_t k, std::vector<std::string> &results) const;
+};
@@ -0,0 +1,129 @@
+/**
+ * @file t9_index.cpp
+ * @brief Реализация индекса по цифрам телефонной клавиатуры.
+ */
+
+#include "t9_index.h"
+#include <algorithm>
+
+/**
+ * @brief Переводит слово в последовательность цифр.
+ * @param word Слово UTF-8.
+ * @param digits Строка для результата.
+ * @return false, если в слове есть символ, которого нет на клавиатуре.
+ */
+bool T9Index::toDigits(std::string_view word, std::string &digits) {
+  digits.clear();
+  for (std::size_t pos = 0; pos < word.size();) {
+    char digit = keypadDigit(nextCodepoint(word, pos));
+    if (!digit)
+      return false;
+    digits += digit;
+  }
+  return true;
+}
+
+/**
+ * @brief Находит узел последовательности цифр.
+ * @param digits Цифры 2..9.
+ * @param create Создавать недостающие узлы.
+ * @return Индекс узла или NO_NODE.
+ */
+NodeId T9Index::walk(std::string_view digits, bool create) {
+  NodeId node = 0;
+  for (char digit : digits) {
+    if (digit < '2' || digit > '9')
+      return NO_NODE;
+    int key = digit - '2';
+    if (nodes[node].next[key] == NO_NODE) {
+      if (!create)
+        return NO_NODE;
+      nodes[node].next[key] = static_cast<NodeId>(nodes.size());
+      nodes.emplace_back();
+    }
+    node = nodes[node].next[key];
+  }
+  return node;
+}
+
+/**
+ * @brief Находит узел последовательности цифр (только чтение).
+ * @param digits Цифры 2..9.
+ * @return Индекс узла или NO_NODE.
+ */
+NodeId T9Index::walk(std::string_view digits) const {
+  NodeId node = 0;
+  for (char digit : digits) {
+    if (digit < '2' || digit > '9')
+      return NO_NODE;
+    node = nodes[node].next[digit - '2'];
+    if (node == NO_NODE)
+      return NO_NODE;
+  }
+  return node;
+}
+
+/**
+ * @brief Добавляет слово или обновляет его вес.
+ * @param word Слово.
+ * @param weight Вес слова.
+ */
+void T9Index::add(std::string_view word, std::uint32_t weight) {
+  std::string digits;
+  if (word.empty() || !toDigits(word, digits))
+    return;
+
+  remove(word);
+
+  std::vector<Candidate> &words = nodes[walk(digits, true)].words;
+  auto position = std::find_if(words.begin(), words.end(), [&](const Candidate &c) {
+    return c.weight < weight || (c.weight == weight && c.word > word);
+  });
+  words.insert(position, Candidate{std::string(word), weight});
+}
+
+/**
+ * @brief Удаляет слово из индекса.
+ * @param word Слово.
+ */
+void T9Index::remove(std::string_view word) {
+  std::string digits;
+  if (!toDigits(word, digits))
+    return;
+
+  NodeId node = walk(digits, false);
+  if (node == NO_NODE)
+    return;
+
+  std::vector<Candidate> &words = nodes[node].words;
+  auto found = std::find_if(words.begin(), words.end(),
+                            [&](const Candidate &c) { return c.word == word; });
+  if (found != words.end())
+    words.erase(found);
+}
+
+/**
+ * @brief Находит слова, набираемые данной последовательностью цифр.
+ * @param digits Цифры 2..9.
+ * @param k Наибольшее число результатов.
+ * @param results Вектор найденных слов.
+ */
+void T9Index::find(std::string_view digits, std::size_t k,
+                   std::vector<std::string> &results) const {
+  results.clear();
+  NodeId node = walk(digits);
+  if (node == NO_NODE)
+    return;
+
+  const std::vector<Candidate> &words = nodes[node].words;
+  for (std::size_t i = 0; i < words.size() && i < k; ++i)
+    results.push_back(words[i].word);
+}
+
+/**
+ * @brief Очищает индекс.
+ */
+void T9Index::clear() {
+  nodes.clear();
+  nodes.emplace_back();
+}
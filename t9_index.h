@@ -0,0 +1,141 @@
+/**
+ * @file t9_index.h
+ * @brief Индекс слов по цифрам телефонной клавиатуры (режим T9).
+ */
+
+#pragma once
+
+#include "alphabet.h"
+#include "node_arena.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define KEYPAD_KEYS 8 ///< Клавиши с буквами: 2..9
+
+/**
+ * @brief Цифра клавиши телефона для буквы.
+ *
+ * @details Латиница — стандартная раскладка (abc=2 ... wxyz=9), кириллица —
+ * русская телефонная раскладка (абвг=2, деёжз=3, ийкл=4, мноп=5, рсту=6,
+ * фхцч=7, шщъы=8, ьэюя=9). Украинские буквы стоят на клавишах близких
+ * русских: ґ=2, є=3, і и ї=4. Раскладка не зависит от алфавита дерева.
+ *
+ * @param cp Кодовая точка
+ * @return Цифра '2'..'9' или 0, если буквы нет на клавиатуре
+ */
+constexpr char keypadDigit(char32_t cp) {
+  constexpr char latin[] = "22233344455566677778889999";
+  constexpr char russian[] = "22223333444455556666777788889999";
+  if (cp >= U'a' && cp <= U'z')
+    return latin[cp - U'a'];
+  if (cp >= U'а' && cp <= U'я')
+    return russian[cp - U'а'];
+  switch (cp) {
+  case U'ё':
+    return '3';
+  case U'ґ':
+    return '2';
+  case U'є':
+    return '3';
+  case U'і':
+  case U'ї':
+    return '4';
+  default:
+    return 0;
+  }
+}
+
+/**
+ * @class T9Index
+ * @brief Дерево по цифрам клавиш, в узлах которого лежат ранжированные слова.
+ *
+ * @details Каждое слово переводится в последовательность цифр и кладётся в
+ * узел, достижимый по этой последовательности. Список слов в узле
+ * поддерживается отсортированным по убыванию веса (при равенстве — по
+ * алфавиту), поэтому запрос стоит O(длина последовательности + k) и не
+ * перебирает буквенные комбинации.
+ */
+class T9Index {
+private:
+  /**
+   * @struct Candidate
+   * @brief Слово с весом.
+   */
+  struct Candidate {
+    std::string word;     ///< Слово
+    std::uint32_t weight; ///< Вес слова
+  };
+
+  /**
+   * @struct KeyNode
+   * @brief Узел дерева цифр.
+   */
+  struct KeyNode {
+    NodeId next[KEYPAD_KEYS];      ///< Потомки по клавишам 2..9
+    std::vector<Candidate> words;  ///< Слова с этой последовательностью цифр
+
+    KeyNode() {
+      for (int i = 0; i < KEYPAD_KEYS; ++i)
+        next[i] = NO_NODE;
+    }
+  };
+
+  std::vector<KeyNode> nodes; ///< Узлы; nodes[0] — корень
+
+  /**
+   * @brief Находит узел последовательности цифр.
+   * @param digits Цифры 2..9
+   * @param create Создавать недостающие узлы
+   * @return Индекс узла или NO_NODE
+   */
+  NodeId walk(std::string_view digits, bool create);
+
+  /**
+   * @brief Находит узел последовательности цифр (только чтение).
+   * @param digits Цифры 2..9
+   * @return Индекс узла или NO_NODE
+   */
+  NodeId walk(std::string_view digits) const;
+
+public:
+  /**
+   * @brief Конструктор. Создаёт пустой индекс.
+   */
+  T9Index() { nodes.emplace_back(); }
+
+  /**
+   * @brief Переводит слово в последовательность цифр.
+   * @param word Слово UTF-8
+   * @param digits Строка для результата
+   * @return false, если в слове есть символ вне алфавита
+   */
+  static bool toDigits(std::string_view word, std::string &digits);
+
+  /**
+   * @brief Добавляет слово или обновляет его вес.
+   * @param word Слово
+   * @param weight Вес слова
+   */
+  void add(std::string_view word, std::uint32_t weight);
+
+  /**
+   * @brief Удаляет слово из индекса.
+   * @param word Слово
+   */
+  void remove(std::string_view word);
+
+  /**
+   * @brief Находит слова, набираемые данной последовательностью цифр.
+   * @param digits Цифры 2..9
+   * @param k Наибольшее число результатов
+   * @param results Вектор найденных слов (по убыванию веса)
+   */
+  void find(std::string_view digits, std::size_t k, std::vector<std::string> &results) const;
+
+  /**
+   * @brief Очищает индекс.
+   */
+  void clear();
+};
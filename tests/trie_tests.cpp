@@ -0,0 +1,347 @@
+/**
+ * @file trie_tests.cpp
+ * @brief Регрессионные проверки словаря, запускаемые через ctest.
+ *
+ * @details Каждая проверка — отдельная функция; имя передаётся первым
+ * аргументом, без аргумента выполняются все. Слова составляются из букв
+ * DefaultAlphabet, поэтому проверки проходят в сборке с любым T9_ALPHABET.
+ * @code
+ * ./T9Tests utf8_overlong
+ * @endcode
+ */
+
+#include "alphabet.h"
+#include "dictionary_store.h"
+#include "journal.h"
+#include "my_exception.h"
+#include "prefix_tree.h"
+#include "t9_index.h"
+#include "utf8_text.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+int failures = 0; ///< Число непрошедших проверок
+
+/**
+ * @brief Засчитывает проверку и печатает место, если она не прошла.
+ * @param ok Результат проверки
+ * @param expr Текст проверяемого выражения
+ * @param line Строка в файле
+ */
+void check(bool ok, const char *expr, int line) {
+  if (!ok) {
+    std::cerr << "trie_tests.cpp:" << line << ": не выполнено " << expr << "\n";
+    ++failures;
+  }
+}
+
+#define CHECK(expr) check(static_cast<bool>(expr), #expr, __LINE__)
+
+/**
+ * @brief Буква алфавита сборки.
+ * @param index Индекс буквы
+ * @return Буква в UTF-8
+ */
+std::string letter(int index) { return std::string(DefaultAlphabet::symbol(index)); }
+
+/**
+ * @brief Избыточные (overlong) двухбайтные формы не декодируются и не
+ * принимаются ни проверкой UTF-8, ни деревом.
+ */
+void testUtf8Overlong() {
+  const std::string overlongA = "\xC1\xA1"; // 'a' в два байта
+  const std::string overlongNul = "\xC0\x80";
+
+  for (const std::string &bad : {overlongA, overlongNul}) {
+    std::size_t pos = 0;
+    CHECK(nextCodepoint(bad, pos) == NO_CODEPOINT);
+    CHECK(pos == 2);
+    CHECK(!isValidUtf8(bad));
+    CHECK(!isValidUtf8Scalar(bad));
+    // Длиннее векторного блока, чтобы проверка не ушла в скалярный хвост.
+    CHECK(!isValidUtf8(std::string(40, 'a') + bad + std::string(40, 'a')));
+  }
+
+  Trie trie;
+  const std::string word = letter(0) + overlongA + letter(1);
+  CHECK(!trie.isValidWord(word));
+  CHECK(!trie.insert(word));
+  CHECK(trie.countByKey("") == 0);
+
+  const std::string good = letter(0) + letter(1);
+  std::size_t pos = 0;
+  CHECK(nextCodepoint(good, pos) == DefaultAlphabet::CODEPOINTS[0]);
+  CHECK(trie.isValidWord(good));
+}
+
+/**
+ * @brief После символа вне алфавита в префиксе буфер пути
+ * восстанавливается, а поиск и курсор ничего не находят.
+ */
+void testCursorPathRestored() {
+  Trie trie;
+  const std::string a = letter(0), b = letter(1), c = letter(2);
+  CHECK(trie.insert(a + b, 3));
+  CHECK(trie.insert(a + b + c, 2));
+  CHECK(trie.insert(b, 1));
+
+  const std::string marker = c + c;
+  std::string buffer = marker;
+  std::vector<std::string> results;
+  for (const std::string &key : {a + "#" + b, a + b + "\xFF", a + "\xC1\xA1", a + c}) {
+    trie.findAllWords(trie.getRoot(), key, 0, buffer, results);
+    CHECK(results.empty());
+    CHECK(buffer == marker);
+
+    auto cursor = trie.completions(key);
+    std::string word;
+    CHECK(!cursor.next(word));
+    CHECK(cursor.done());
+
+    trie.findAllByKey(key, results);
+    CHECK(results.empty());
+  }
+
+  // Тот же буфер после неудачных поисков даёт правильные слова.
+  trie.findAllWords(trie.getRoot(), a, 0, buffer, results);
+  CHECK((results == std::vector<std::string>{marker + a + b, marker + a + b + c}));
+  CHECK(buffer == marker);
+
+  auto cursor = trie.completions(a);
+  std::vector<std::string> page;
+  CHECK(cursor.nextPage(10, page) == 2);
+  CHECK((page == std::vector<std::string>{a + b, a + b + c}));
+}
+
+/**
+ * @struct TempDir
+ * @brief Временный каталог проверки; удаляется вместе с содержимым.
+ */
+struct TempDir {
+  std::filesystem::path path; ///< Путь к каталогу
+
+  /**
+   * @brief Создаёт каталог с уникальным именем.
+   * @param name Префикс имени
+   */
+  explicit TempDir(const std::string &name)
+      : path(std::filesystem::temp_directory_path() /
+             (name + "_" +
+              std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()))) {
+    std::filesystem::create_directories(path);
+  }
+
+  /**
+   * @brief Деструктор. Удаляет каталог.
+   */
+  ~TempDir() {
+    std::error_code ignored;
+    std::filesystem::remove_all(path, ignored);
+  }
+};
+
+/**
+ * @brief Размер записи журнала со словом.
+ * @param word Слово
+ * @return Байт в файле
+ */
+std::uintmax_t recordBytes(const std::string &word) { return sizeof(JournalRecord) + word.size(); }
+
+/**
+ * @brief Журнал воспроизводится в чистое дерево; обрезанная и мусорная
+ * последняя запись отбрасывается, файл укорачивается до целых записей, и
+ * дозапись после восстановления снова читается.
+ */
+void testJournalReplay() {
+  TempDir dir("t9_journal_test");
+  const std::string snapshot = (dir.path / "dict.snap").string();
+  const std::string a = letter(0), b = letter(1), c = letter(2);
+
+  std::uintmax_t fullSize = 0;
+  {
+    Trie trie;
+    DictionaryStore store(trie, snapshot);
+    RecoveryStats empty = store.recover();
+    CHECK(empty.records == 0);
+    CHECK(empty.discardedBytes == 0);
+
+    CHECK(store.insert(a + b, 5));
+    CHECK(store.insert(a + b + c, 7));
+    CHECK(store.insert(b, 1));
+    CHECK(store.remove(a + b));
+    CHECK(store.insert(c, 2));
+
+    // Удаление не записалось бы в журнал: дерево не должно меняться.
+    std::string huge;
+    while (huge.size() <= JOURNAL_MAX_WORD)
+      huge += a;
+    CHECK(trie.insert(huge));
+    bool thrown = false;
+    try {
+      store.remove(huge);
+    } catch (const JournalException &) {
+      thrown = true;
+    }
+    CHECK(thrown);
+    CHECK(trie.findOneByKey(huge));
+    CHECK(trie.delWord(trie.getRoot(), huge, 0));
+    store.sync();
+    store.close();
+    fullSize = std::filesystem::file_size(store.journalPath());
+  }
+
+  const std::string journal = snapshot + ".journal";
+  const std::uintmax_t intactSize = fullSize - recordBytes(c);
+
+  // Сбой посреди записи последнего изменения.
+  std::filesystem::resize_file(journal, fullSize - 3);
+  {
+    Trie trie;
+    DictionaryStore store(trie, snapshot);
+    RecoveryStats stats = store.recover();
+    CHECK(stats.records == 4);
+    CHECK(stats.discardedBytes == recordBytes(c) - 3);
+    CHECK(std::filesystem::file_size(journal) == intactSize);
+
+    CHECK(!trie.findOneByKey(a + b));
+    CHECK(trie.getWeight(a + b + c) == 7);
+    CHECK(trie.findOneByKey(b));
+    CHECK(!trie.findOneByKey(c));
+    CHECK(trie.countByKey("") == 2);
+
+    CHECK(store.insert(c, 4));
+    store.sync();
+  }
+
+  // Мусор после целых записей.
+  const std::uintmax_t appendedSize = intactSize + recordBytes(c);
+  CHECK(std::filesystem::file_size(journal) == appendedSize);
+  {
+    std::ofstream tail(journal, std::ios::binary | std::ios::app);
+    tail << "\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0A\x0B\x0C\x0D";
+  }
+  {
+    Trie trie;
+    DictionaryStore store(trie, snapshot);
+    RecoveryStats stats = store.recover();
+    CHECK(stats.records == 5);
+    CHECK(stats.discardedBytes == 13);
+    CHECK(std::filesystem::file_size(journal) == appendedSize);
+    CHECK(trie.getWeight(c) == 4);
+    CHECK(trie.getWeight(a + b + c) == 7);
+    CHECK(trie.countByKey("") == 3);
+  }
+}
+
+/**
+ * @brief Удаление освобождает узлы, которые больше не ведут к словам, и
+ * пересчитывает у предков число слов и наибольший вес поддерева.
+ */
+void testDelWordPrunes() {
+  Trie trie;
+  const std::string a = letter(0), b = letter(1), c = letter(2), d = letter(3), e = letter(4);
+  CHECK(trie.insert(a + b + c, 9));
+  CHECK(trie.insert(a + b + d, 2));
+  CHECK(trie.insert(a + e, 4));
+  CHECK(trie.insert(b, 1));
+
+  std::string digits;
+  bool keypad = T9Index::toDigits(a + b + c, digits);
+  std::vector<std::string> results;
+  if (keypad) {
+    trie.findByDigits(digits, 10, results);
+    CHECK(std::find(results.begin(), results.end(), a + b + c) != results.end());
+  }
+
+  // Лист под общим с другим словом узлом: освобождается только он.
+  std::size_t live = trie.nodeUsage().liveNodes;
+  CHECK(trie.delWord(trie.getRoot(), a + b + c, 0));
+  CHECK(trie.nodeUsage().liveNodes == live - 1);
+  CHECK(!trie.findOneByKey(a + b + c));
+  CHECK(trie.countByKey("") == 3);
+  CHECK(trie.countByKey(a) == 2);
+  CHECK(trie.countByKey(a + b) == 1);
+  trie.findTopByKey("", 1, results);
+  CHECK((results == std::vector<std::string>{a + e}));
+  trie.findTopByKey(a + b, 1, results);
+  CHECK((results == std::vector<std::string>{a + b + d}));
+  if (keypad) {
+    trie.findByDigits(digits, 10, results);
+    CHECK(std::find(results.begin(), results.end(), a + b + c) == results.end());
+  }
+
+  // Последнее слово ветки: освобождается вся цепочка без слов.
+  live = trie.nodeUsage().liveNodes;
+  CHECK(trie.delWord(trie.getRoot(), a + b + d, 0));
+  CHECK(trie.nodeUsage().liveNodes == live - 2);
+  CHECK(trie.countByKey(a + b) == 0);
+  trie.findAllByKey(a, results);
+  CHECK((results == std::vector<std::string>{a + e}));
+
+  // Отсутствующее слово и префикс без слова ничего не меняют.
+  live = trie.nodeUsage().liveNodes;
+  CHECK(!trie.delWord(trie.getRoot(), a + b + d, 0));
+  CHECK(!trie.delWord(trie.getRoot(), a, 0));
+  CHECK(trie.nodeUsage().liveNodes == live);
+  CHECK(trie.countByKey("") == 2);
+
+  // Слово во внутреннем узле: узел остаётся, его вес уходит из максимумов.
+  CHECK(trie.insert(a, 8));
+  trie.findTopByKey("", 1, results);
+  CHECK((results == std::vector<std::string>{a}));
+  live = trie.nodeUsage().liveNodes;
+  CHECK(trie.delWord(trie.getRoot(), a, 0));
+  CHECK(trie.nodeUsage().liveNodes == live);
+  trie.findTopByKey("", 2, results);
+  CHECK((results == std::vector<std::string>{a + e, b}));
+
+  // После удаления всех слов остаётся только корень.
+  CHECK(trie.delWord(trie.getRoot(), a + e, 0));
+  CHECK(trie.delWord(trie.getRoot(), b, 0));
+  CHECK(trie.nodeUsage().liveNodes == 1);
+  CHECK(trie.countByKey("") == 0);
+}
+
+/**
+ * @struct TestCase
+ * @brief Имя проверки и её функция.
+ */
+struct TestCase {
+  const char *name; ///< Имя для командной строки
+  void (*run)();    ///< Проверка
+};
+
+const TestCase TESTS[] = {
+    {"utf8_overlong", testUtf8Overlong},
+    {"cursor_path_restored", testCursorPathRestored},
+    {"journal_replay", testJournalReplay},
+    {"delword_prunes", testDelWordPrunes},
+};
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  bool found = false;
+  for (const TestCase &test : TESTS) {
+    if (argc > 1 && std::strcmp(argv[1], test.name) != 0)
+      continue;
+    found = true;
+    int before = failures;
+    test.run();
+    std::cout << (failures == before ? "OK   " : "FAIL ") << test.name << "\n";
+  }
+  if (!found) {
+    std::cerr << "Неизвестная проверка: " << argv[1] << "\n";
+    return 2;
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,316 @@
+/**
+ * @file trie_metrics.cpp
+ * @brief Реализация метрик словаря.
+ */
+
+#include "trie_metrics.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+/**
+ * @brief Имена величин в порядке Metric.
+ */
+const char *const METRIC_NAMES[] = {"find_all_visited", "find_all_results", "sugg_latency_ns",
+                                    "add_latency_ns", "del_latency_ns"};
+
+static_assert(sizeof(METRIC_NAMES) / sizeof(METRIC_NAMES[0]) ==
+                  static_cast<std::size_t>(Metric::COUNT),
+              "у каждой величины должно быть имя");
+
+/**
+ * @brief Верхняя граница значений корзины.
+ * @param bucket Номер корзины.
+ * @return Наибольшее значение, попадающее в корзину.
+ */
+std::uint64_t bucketLimit(int bucket) {
+  if (bucket == 0)
+    return 0;
+  if (bucket == METRIC_BUCKETS - 1)
+    return ~std::uint64_t(0);
+  return (std::uint64_t(1) << bucket) - 1;
+}
+
+/**
+ * @brief Печатает массив чисел в формате JSON.
+ * @param values Числа.
+ * @param count Сколько первых чисел вывести.
+ * @param out Поток вывода.
+ */
+template <typename T> void writeJsonArray(const T &values, std::size_t count, std::ostream &out) {
+  out << '[';
+  for (std::size_t i = 0; i < count; ++i)
+    out << (i ? "," : "") << values[i];
+  out << ']';
+}
+
+#if defined(T9_METRICS)
+
+/**
+ * @brief Номер корзины для значения.
+ * @param value Значение.
+ * @return 0 для нуля, иначе число значащих бит (не больше последней корзины).
+ */
+int bucketOf(std::uint64_t value) {
+  if (value == 0)
+    return 0;
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanReverse64(&index, value);
+  int bits = static_cast<int>(index) + 1;
+#else
+  int bits = 64 - __builtin_clzll(value);
+#endif
+  return bits < METRIC_BUCKETS ? bits : METRIC_BUCKETS - 1;
+}
+
+/**
+ * @brief Прибавляет к счётчику, который пишет только поток-владелец.
+ * @details Чтение и запись по отдельности атомарны, поэтому сборщик может
+ * читать счётчик из другого потока, а владелец не платит за
+ * read-modify-write.
+ * @param counter Счётчик.
+ * @param value Прибавка.
+ */
+void bump(std::atomic<std::uint64_t> &counter, std::uint64_t value) {
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+/**
+ * @struct ThreadHistogram
+ * @brief Гистограмма одной величины в одном потоке.
+ */
+struct ThreadHistogram {
+  std::atomic<std::uint64_t> count{0}; ///< Число замеров
+  std::atomic<std::uint64_t> sum{0};   ///< Сумма значений
+  std::atomic<std::uint64_t> max{0};   ///< Наибольшее значение
+  std::array<std::atomic<std::uint64_t>, METRIC_BUCKETS> buckets{}; ///< Замеры по корзинам
+
+  /**
+   * @brief Прибавляет гистограмму к собранной.
+   * @param total Собранная гистограмма.
+   */
+  void addTo(HistogramData &total) const {
+    total.count += count.load(std::memory_order_relaxed);
+    total.sum += sum.load(std::memory_order_relaxed);
+    std::uint64_t m = max.load(std::memory_order_relaxed);
+    if (m > total.max)
+      total.max = m;
+    for (int i = 0; i < METRIC_BUCKETS; ++i)
+      total.buckets[i] += buckets[i].load(std::memory_order_relaxed);
+  }
+};
+
+struct ThreadMetrics;
+
+/**
+ * @struct Registry
+ * @brief Гистограммы живых потоков и сумма по завершившимся.
+ */
+struct Registry {
+  std::mutex mutex;                     ///< Защищает список и сумму
+  std::vector<ThreadMetrics *> threads; ///< Живые потоки
+  MetricsSnapshot retired{};            ///< Сумма по завершившимся потокам
+};
+
+/**
+ * @brief Общий реестр (создаётся при первом обращении).
+ * @return Ссылка на реестр.
+ */
+Registry &registry() {
+  static Registry instance;
+  return instance;
+}
+
+/**
+ * @struct ThreadMetrics
+ * @brief Гистограммы одного потока. Регистрируются при первом замере в
+ * потоке и переносятся в сумму завершившихся при его завершении.
+ */
+struct ThreadMetrics {
+  std::array<ThreadHistogram, static_cast<int>(Metric::COUNT)> histograms; ///< По Metric
+
+  ThreadMetrics() {
+    Registry &shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    shared.threads.push_back(this);
+  }
+
+  ~ThreadMetrics() {
+    Registry &shared = registry();
+    std::lock_guard<std::mutex> lock(shared.mutex);
+    addTo(shared.retired);
+    for (std::size_t i = 0; i < shared.threads.size(); ++i)
+      if (shared.threads[i] == this) {
+        shared.threads[i] = shared.threads.back();
+        shared.threads.pop_back();
+        break;
+      }
+  }
+
+  /**
+   * @brief Прибавляет гистограммы потока к собранным.
+   * @param total Собранные гистограммы.
+   */
+  void addTo(MetricsSnapshot &total) const {
+    for (std::size_t i = 0; i < histograms.size(); ++i)
+      histograms[i].addTo(total.histograms[i]);
+  }
+};
+
+thread_local ThreadMetrics localMetrics; ///< Гистограммы текущего потока
+
+#endif
+
+} // namespace
+
+/**
+ * @brief Оценка перцентиля по корзинам.
+ * @param q Доля.
+ * @return Верхняя граница корзины перцентиля.
+ */
+std::uint64_t HistogramData::percentile(double q) const {
+  if (count == 0)
+    return 0;
+  std::uint64_t target = static_cast<std::uint64_t>(q * static_cast<double>(count));
+  if (target == 0)
+    target = 1;
+  std::uint64_t seen = 0;
+  for (int i = 0; i < METRIC_BUCKETS; ++i) {
+    seen += buckets[i];
+    if (seen >= target)
+      return bucketLimit(i) < max ? bucketLimit(i) : max;
+  }
+  return max;
+}
+
+/**
+ * @brief Имя величины для вывода.
+ * @param metric Величина.
+ * @return Имя в snake_case.
+ */
+const char *metricName(Metric metric) { return METRIC_NAMES[static_cast<int>(metric)]; }
+
+#if defined(T9_METRICS)
+
+/**
+ * @brief Записывает замер в гистограмму текущего потока.
+ * @param metric Величина.
+ * @param value Значение.
+ */
+void recordMetric(Metric metric, std::uint64_t value) {
+  ThreadHistogram &h = localMetrics.histograms[static_cast<int>(metric)];
+  bump(h.count, 1);
+  bump(h.sum, value);
+  if (value > h.max.load(std::memory_order_relaxed))
+    h.max.store(value, std::memory_order_relaxed);
+  bump(h.buckets[bucketOf(value)], 1);
+}
+
+/**
+ * @brief Собирает гистограммы всех потоков.
+ * @return Сумма по живым и завершившимся потокам.
+ */
+MetricsSnapshot collectMetrics() {
+  Registry &shared = registry();
+  std::lock_guard<std::mutex> lock(shared.mutex);
+  MetricsSnapshot total = shared.retired;
+  for (const ThreadMetrics *thread : shared.threads)
+    thread->addTo(total);
+  return total;
+}
+
+#endif
+
+/**
+ * @brief Печатает форму дерева и гистограммы в читаемом виде.
+ * @param trie Дерево.
+ * @param out Поток вывода.
+ */
+void printDictionaryStats(const Trie &trie, std::ostream &out) {
+  TrieShape shape = trie.shape();
+  out << "Узлов: " << shape.nodes << ", слов: " << shape.words << ", память: " << shape.bytes
+      << " байт" << std::endl;
+  out << "Свободно в арене: узлов " << shape.arena.deadNodes << ", ссылок "
+      << shape.arena.deadLinks << std::endl;
+  out << "Глубина: узлов / слов" << std::endl;
+  for (std::size_t depth = 0; depth < shape.nodesByDepth.size(); ++depth)
+    out << "  " << depth << ": " << shape.nodesByDepth[depth] << " / "
+        << shape.wordsByDepth[depth] << std::endl;
+
+  if (const PrefixCache *cache = trie.prefixCache()) {
+    PrefixCacheStats c = cache->stats();
+    std::uint64_t lookups = c.hits + c.misses;
+    out << "Кэш префиксов: попаданий " << c.hits << " из " << lookups << " ("
+        << (lookups ? 100.0 * static_cast<double>(c.hits) / static_cast<double>(lookups) : 0.0)
+        << "%), сэкономлено узлов " << c.savedNodes << " и " << c.savedNanos / 1000000.0
+        << " мс обхода" << std::endl;
+    out << "  записей " << c.entries << ", память " << c.bytes << " из " << c.capacity
+        << " байт, вытеснено " << c.evictions << ", сброшено изменениями " << c.invalidations
+        << std::endl;
+  }
+
+#if defined(T9_METRICS)
+  MetricsSnapshot metrics = collectMetrics();
+  out << "Замеры: число, среднее, p50, p90, p99, max" << std::endl;
+  for (int i = 0; i < static_cast<int>(Metric::COUNT); ++i) {
+    const HistogramData &h = metrics.histograms[i];
+    out << "  " << metricName(static_cast<Metric>(i)) << ": " << h.count << ", "
+        << (h.count ? h.sum / h.count : 0) << ", " << h.percentile(0.5) << ", "
+        << h.percentile(0.9) << ", " << h.percentile(0.99) << ", " << h.max << std::endl;
+  }
+#else
+  out << "Замеры отключены при сборке (T9_METRICS=OFF)." << std::endl;
+#endif
+}
+
+/**
+ * @brief Выводит форму дерева и гистограммы одним объектом JSON.
+ * @param trie Дерево.
+ * @param out Поток вывода.
+ */
+void writeDictionaryStatsJson(const Trie &trie, std::ostream &out) {
+  TrieShape shape = trie.shape();
+  out << "{\"nodes\": " << shape.nodes << ", \"words\": " << shape.words
+      << ", \"bytes\": " << shape.bytes << ", \"dead_nodes\": " << shape.arena.deadNodes
+      << ", \"dead_links\": " << shape.arena.deadLinks << ", \"nodes_by_depth\": ";
+  writeJsonArray(shape.nodesByDepth, shape.nodesByDepth.size(), out);
+  out << ", \"words_by_depth\": ";
+  writeJsonArray(shape.wordsByDepth, shape.wordsByDepth.size(), out);
+
+  if (const PrefixCache *cache = trie.prefixCache()) {
+    PrefixCacheStats c = cache->stats();
+    out << ", \"prefix_cache\": {\"hits\": " << c.hits << ", \"misses\": " << c.misses
+        << ", \"stores\": " << c.stores << ", \"evictions\": " << c.evictions
+        << ", \"invalidations\": " << c.invalidations << ", \"saved_nodes\": " << c.savedNodes
+        << ", \"saved_ns\": " << c.savedNanos << ", \"entries\": " << c.entries
+        << ", \"bytes\": " << c.bytes << ", \"capacity\": " << c.capacity << '}';
+  }
+
+#if defined(T9_METRICS)
+  MetricsSnapshot metrics = collectMetrics();
+  out << ", \"metrics_enabled\": true, \"metrics\": {";
+  for (int i = 0; i < static_cast<int>(Metric::COUNT); ++i) {
+    const HistogramData &h = metrics.histograms[i];
+    int used = METRIC_BUCKETS;
+    while (used > 0 && h.buckets[used - 1] == 0)
+      --used;
+    out << (i ? ", " : "") << '"' << metricName(static_cast<Metric>(i))
+        << "\": {\"count\": " << h.count << ", \"sum\": " << h.sum << ", \"max\": " << h.max
+        << ", \"p50\": " << h.percentile(0.5) << ", \"p90\": " << h.percentile(0.9)
+        << ", \"p99\": " << h.percentile(0.99) << ", \"buckets\": ";
+    writeJsonArray(h.buckets, static_cast<std::size_t>(used), out);
+    out << '}';
+  }
+  out << '}';
+#else
+  out << ", \"metrics_enabled\": false";
+#endif
+  out << '}' << std::endl;
+}
@@ -0,0 +1,167 @@
+/**
+ * @file trie_metrics.h
+ * @brief Метрики словаря: гистограммы горячих путей и форма дерева.
+ *
+ * @details Замеры пишутся в гистограммы с фиксированными корзинами по
+ * степеням двойки. У каждого потока свой набор гистограмм: запись — это
+ * несколько обычных сложений без блокировок и без атомарных
+ * read-modify-write, общий набор собирается только при чтении. Если проект
+ * собран без T9_METRICS (опция CMake T9_METRICS=OFF), макросы T9_RECORD и
+ * T9_LATENCY раскрываются в пустые выражения, а /stats и --stats выводят
+ * только форму дерева.
+ */
+
+#pragma once
+
+#include "prefix_tree.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @enum Metric
+ * @brief Измеряемая величина.
+ */
+enum class Metric : int {
+  FindAllVisited, ///< Узлов пройдено за findAllByKey
+  FindAllResults, ///< Слов найдено за findAllByKey
+  SuggLatency,    ///< Время ответа на префикс (/sugg и пакетный режим), нс
+  AddLatency,     ///< Время /add, нс (в меню — вместе с ожиданием fsync журнала)
+  DelLatency,     ///< Время /del, нс (в меню — вместе с ожиданием fsync журнала)
+  COUNT           ///< Число величин
+};
+
+/**
+ * @brief Число корзин гистограммы.
+ * @details Корзина 0 — значение 0, корзина i — значения [2^(i-1), 2^i),
+ * последняя принимает всё большее.
+ */
+constexpr int METRIC_BUCKETS = 40;
+
+/**
+ * @struct HistogramData
+ * @brief Собранная гистограмма одной величины.
+ */
+struct HistogramData {
+  std::uint64_t count = 0; ///< Число замеров
+  std::uint64_t sum = 0;   ///< Сумма значений
+  std::uint64_t max = 0;   ///< Наибольшее значение
+  std::array<std::uint64_t, METRIC_BUCKETS> buckets{}; ///< Замеры по корзинам
+
+  /**
+   * @brief Оценка перцентиля по корзинам.
+   * @param q Доля (0..1)
+   * @return Верхняя граница корзины, в которую попадает перцентиль (не
+   * больше max)
+   */
+  std::uint64_t percentile(double q) const;
+};
+
+/**
+ * @struct MetricsSnapshot
+ * @brief Гистограммы всех величин, собранные со всех потоков.
+ */
+struct MetricsSnapshot {
+  std::array<HistogramData, static_cast<int>(Metric::COUNT)> histograms; ///< По Metric
+
+  /**
+   * @brief Гистограмма величины.
+   * @param metric Величина
+   * @return Ссылка на гистограмму
+   */
+  const HistogramData &operator[](Metric metric) const {
+    return histograms[static_cast<int>(metric)];
+  }
+};
+
+/**
+ * @brief Имя величины для вывода.
+ * @param metric Величина
+ * @return Имя в snake_case
+ */
+const char *metricName(Metric metric);
+
+#if defined(T9_METRICS)
+
+/**
+ * @brief Записывает замер в гистограмму текущего потока.
+ * @param metric Величина
+ * @param value Значение
+ */
+void recordMetric(Metric metric, std::uint64_t value);
+
+/**
+ * @brief Собирает гистограммы всех потоков, включая завершившиеся.
+ * @return Сумма по потокам
+ */
+MetricsSnapshot collectMetrics();
+
+/**
+ * @class ScopedLatency
+ * @brief Записывает время жизни объекта в гистограмму задержки.
+ */
+class ScopedLatency {
+private:
+  Metric metric;                                ///< Величина
+  std::chrono::steady_clock::time_point start; ///< Начало замера
+
+public:
+  /**
+   * @brief Конструктор. Запоминает время начала.
+   * @param metric Величина
+   */
+  explicit ScopedLatency(Metric metric)
+      : metric(metric), start(std::chrono::steady_clock::now()) {}
+
+  /**
+   * @brief Деструктор. Записывает прошедшее время в наносекундах.
+   */
+  ~ScopedLatency() {
+    recordMetric(metric, static_cast<std::uint64_t>(
+                             std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count()));
+  }
+
+  ScopedLatency(const ScopedLatency &) = delete;
+  ScopedLatency &operator=(const ScopedLatency &) = delete;
+};
+
+#define T9_METRIC_CONCAT2(a, b) a##b
+#define T9_METRIC_CONCAT(a, b) T9_METRIC_CONCAT2(a, b)
+
+/**
+ * @brief Записывает значение value величины metric.
+ */
+#define T9_RECORD(metric, value) recordMetric(metric, value)
+
+/**
+ * @brief Замеряет время до конца текущего блока.
+ */
+#define T9_LATENCY(metric) ScopedLatency T9_METRIC_CONCAT(t9Latency, __LINE__)(metric)
+
+#else
+
+// Значение не вычисляется, но считается использованным.
+#define T9_RECORD(metric, value) ((void)sizeof(value))
+#define T9_LATENCY(metric) ((void)0)
+
+#endif
+
+/**
+ * @brief Печатает форму дерева, счётчики кэша префиксов (если он включён)
+ * и гистограммы в читаемом виде.
+ * @param trie Дерево
+ * @param out Поток вывода
+ */
+void printDictionaryStats(const Trie &trie, std::ostream &out);
+
+/**
+ * @brief Выводит форму дерева, счётчики кэша префиксов (если он включён)
+ * и гистограммы одним объектом JSON.
+ * @param trie Дерево
+ * @param out Поток вывода
+ */
+void writeDictionaryStatsJson(const Trie &trie, std::ostream &out);
@@ -0,0 +1,182 @@
+/**
+ * @file trie_snapshot.cpp
+ * @brief Запись и загрузка двоичного снимка Trie.
+ */
+
+#include "trie_snapshot.h"
+#include "my_exception.h"
+#include "prefix_tree.h"
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Контрольная сумма блока данных.
+ * @param data Начало блока.
+ * @param size Размер блока в байтах.
+ * @param seed Начальное значение.
+ * @return Значение контрольной суммы.
+ */
+std::uint64_t snapshotChecksum(const void *data, std::size_t size, std::uint64_t seed) {
+  const unsigned char *bytes = static_cast<const unsigned char *>(data);
+  std::uint64_t hash = seed;
+  std::size_t i = 0;
+
+  for (; i + 8 <= size; i += 8) {
+    std::uint64_t word;
+    std::memcpy(&word, bytes + i, 8);
+    hash = (hash ^ word) * 0x100000001B3ull;
+    hash ^= hash >> 29;
+  }
+  for (; i < size; ++i)
+    hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+
+  return hash ^ (hash >> 32);
+}
+
+/**
+ * @brief Записывает блоки в файл атомарно.
+ * @param path Путь к файлу.
+ * @param blocks Блоки данных по порядку.
+ * @throws SnapshotException если файл не удалось записать.
+ */
+void writeFileAtomically(const std::string &path, std::initializer_list<FileBlock> blocks) {
+  std::string tmpPath = path + ".tmp";
+  std::FILE *file = std::fopen(tmpPath.c_str(), "wb");
+  if (!file)
+    throw SnapshotException(path, "не удалось открыть файл для записи");
+
+  bool ok = true;
+  for (const FileBlock &block : blocks)
+    if (ok && block.size)
+      ok = std::fwrite(block.data, block.size, 1, file) == 1;
+  ok = ok && std::fflush(file) == 0;
+#if !defined(_WIN32)
+  ok = ok && fsync(fileno(file)) == 0;
+#endif
+  ok = (std::fclose(file) == 0) && ok;
+
+  if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+    std::remove(tmpPath.c_str());
+    throw SnapshotException(path, "ошибка записи");
+  }
+}
+
+/**
+ * @brief Заполняет заголовок снимка по текущему дереву.
+ * @param header Заголовок.
+ */
+template <typename Alphabet>
+void BasicTrie<Alphabet>::fillSnapshotHeader(SnapshotHeader &header) const {
+  header = SnapshotHeader{};
+  std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+  header.version = SNAPSHOT_VERSION;
+  header.nodeSize = sizeof(Node);
+  header.alphabet = Alphabet::FINGERPRINT;
+  header.nodeCount = arena.nodeCount();
+  header.linkCount = arena.linkCount();
+  header.root = root;
+  header.arena = arena.state();
+
+  std::size_t nodeBytes = arena.nodeCount() * sizeof(Node);
+  std::size_t linkBytes = arena.linkCount() * sizeof(NodeId);
+  header.checksum = snapshotChecksum(arena.linkData(), linkBytes,
+                                     snapshotChecksum(arena.nodeData(), nodeBytes));
+}
+
+/**
+ * @brief Сохраняет дерево в двоичный снимок.
+ * @param path Путь к файлу.
+ * @throws SnapshotException если файл не удалось записать.
+ */
+template <typename Alphabet>
+void BasicTrie<Alphabet>::save(const std::string &path) const {
+  SnapshotHeader header;
+  fillSnapshotHeader(header);
+  writeFileAtomically(path, {{&header, sizeof(header)},
+                             {arena.nodeData(), arena.nodeCount() * sizeof(Node)},
+                             {arena.linkData(), arena.linkCount() * sizeof(NodeId)}});
+}
+
+/**
+ * @brief Собирает снимок дерева в памяти.
+ * @param image Буфер снимка.
+ */
+template <typename Alphabet>
+void BasicTrie<Alphabet>::saveImage(std::vector<char> &image) const {
+  SnapshotHeader header;
+  fillSnapshotHeader(header);
+  std::size_t nodeBytes = arena.nodeCount() * sizeof(Node);
+  std::size_t linkBytes = arena.linkCount() * sizeof(NodeId);
+
+  image.resize(sizeof(header) + nodeBytes + linkBytes);
+  std::memcpy(image.data(), &header, sizeof(header));
+  if (nodeBytes)
+    std::memcpy(image.data() + sizeof(header), arena.nodeData(), nodeBytes);
+  if (linkBytes)
+    std::memcpy(image.data() + sizeof(header) + nodeBytes, arena.linkData(), linkBytes);
+}
+
+/**
+ * @brief Загружает дерево из снимка, отображая файл в память.
+ * @param path Путь к файлу.
+ * @param verify Проверять контрольную сумму данных.
+ * @throws SnapshotException если файл отсутствует, повреждён или устарел.
+ */
+template <typename Alphabet>
+void BasicTrie<Alphabet>::load(const std::string &path, bool verify) {
+  MappedFile file;
+  if (!file.open(path))
+    throw SnapshotException(path, "не удалось открыть файл");
+
+  if (file.size() < sizeof(SnapshotHeader))
+    throw SnapshotException(path, "файл обрезан");
+
+  SnapshotHeader header;
+  std::memcpy(&header, file.data(), sizeof(header));
+
+  if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0)
+    throw SnapshotException(path, "неизвестный формат");
+  if (header.version != SNAPSHOT_VERSION || header.nodeSize != sizeof(Node))
+    throw SnapshotException(path, "устаревшая или несовместимая версия");
+  if (header.alphabet != Alphabet::FINGERPRINT)
+    throw SnapshotException(path, "записан для другого алфавита");
+
+  std::size_t nodeBytes = header.nodeCount * sizeof(Node);
+  std::size_t linkBytes = header.linkCount * sizeof(NodeId);
+  if (file.size() != sizeof(header) + nodeBytes + linkBytes)
+    throw SnapshotException(path, "размер файла не совпадает с заголовком");
+  if (header.root >= header.nodeCount)
+    throw SnapshotException(path, "некорректный корень");
+
+  const char *nodes = file.data() + sizeof(header);
+  const char *links = nodes + nodeBytes;
+
+  if (verify && header.checksum != snapshotChecksum(links, linkBytes,
+                                                    snapshotChecksum(nodes, nodeBytes)))
+    throw SnapshotException(path, "контрольная сумма не совпадает");
+
+  arena.attach(std::move(file), reinterpret_cast<const Node *>(nodes), header.nodeCount,
+               reinterpret_cast<const NodeId *>(links), header.linkCount, header.arena);
+  root = header.root;
+  keypad.reset();
+  if (cache)
+    cache->clear();
+}
+
+template void BasicTrie<LatinAlphabet>::save(const std::string &) const;
+template void BasicTrie<LatinAlphabet>::saveImage(std::vector<char> &) const;
+template void BasicTrie<LatinAlphabet>::load(const std::string &, bool);
+template void BasicTrie<RussianAlphabet>::save(const std::string &) const;
+template void BasicTrie<RussianAlphabet>::saveImage(std::vector<char> &) const;
+template void BasicTrie<RussianAlphabet>::load(const std::string &, bool);
+template void BasicTrie<MixedAlphabet>::save(const std::string &) const;
+template void BasicTrie<MixedAlphabet>::saveImage(std::vector<char> &) const;
+template void BasicTrie<MixedAlphabet>::load(const std::string &, bool);
+template void BasicTrie<UkrainianAlphabet>::save(const std::string &) const;
+template void BasicTrie<UkrainianAlphabet>::saveImage(std::vector<char> &) const;
+template void BasicTrie<UkrainianAlphabet>::load(const std::string &, bool);
@@ -0,0 +1,75 @@
+/**
+ * @file trie_snapshot.h
+ * @brief Формат двоичного снимка Trie.
+ *
+ * @details Снимок — плоский файл без указателей: заголовок, затем массив
+ * узлов арены и пул ссылок в том виде, в каком они лежат в памяти. Такой
+ * файл можно отобразить в память и выполнять поиск прямо по нему.
+ * Порядок байт и раскладка узла — родные для платформы; чужой файл
+ * отвергается по полям заголовка.
+ */
+
+#pragma once
+
+#include "node_arena.h"
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+
+/**
+ * @brief Сигнатура файла снимка.
+ */
+constexpr char SNAPSHOT_MAGIC[8] = {'T', '9', 'T', 'R', 'I', 'E', '\r', '\n'};
+
+/**
+ * @brief Текущая версия формата снимка (2 — узлы хранят число слов
+ * поддерева, 3 — в заголовке есть отпечаток алфавита).
+ */
+constexpr std::uint32_t SNAPSHOT_VERSION = 3;
+
+/**
+ * @struct SnapshotHeader
+ * @brief Заголовок файла снимка.
+ */
+struct SnapshotHeader {
+  char magic[8];                ///< Сигнатура SNAPSHOT_MAGIC
+  std::uint32_t version;        ///< Версия формата
+  std::uint32_t nodeSize;       ///< Размер узла на момент записи
+  std::uint64_t nodeCount;      ///< Число узлов в файле
+  std::uint64_t linkCount;      ///< Число ссылок в файле
+  std::uint64_t checksum;       ///< Контрольная сумма узлов и ссылок
+  std::uint32_t root;           ///< Индекс корня
+  std::uint32_t alphabet;       ///< Отпечаток алфавита (BasicAlphabet::FINGERPRINT)
+  ArenaState arena;             ///< Состояние арены
+};
+
+/**
+ * @brief Контрольная сумма блока данных (64-битная, по словам).
+ * @param data Начало блока
+ * @param size Размер блока в байтах
+ * @param seed Начальное значение (для продолжения по нескольким блокам)
+ * @return Значение контрольной суммы
+ */
+std::uint64_t snapshotChecksum(const void *data, std::size_t size,
+                               std::uint64_t seed = 0x9E3779B97F4A7C15ull);
+
+/**
+ * @struct FileBlock
+ * @brief Блок данных для записи в файл.
+ */
+struct FileBlock {
+  const void *data; ///< Начало блока
+  std::size_t size; ///< Размер в байтах
+};
+
+/**
+ * @brief Записывает блоки в файл атомарно.
+ * @details Данные пишутся во временный файл рядом, сбрасываются на диск
+ * (fsync) и переименовываются поверх path: после сбоя на диске остаётся
+ * либо старый, либо новый файл целиком.
+ * @param path Путь к файлу
+ * @param blocks Блоки данных по порядку
+ * @throws SnapshotException если файл не удалось записать
+ */
+void writeFileAtomically(const std::string &path, std::initializer_list<FileBlock> blocks);
@@ -0,0 +1,129 @@
+/**
+ * @file typing_session.cpp
+ * @brief Реализация сессии набора.
+ */
+
+#include "typing_session.h"
+#include "alphabet.h"
+#include "prefix_tree.h"
+#include <algorithm>
+
+/**
+ * @brief Конструктор. Начинает сессию с пустым префиксом.
+ * @param trie Дерево.
+ * @param k Число подсказок.
+ */
+TypingSession::TypingSession(const Trie &trie, std::size_t k) : trie(&trie), limit(k) {
+  reset();
+}
+
+/**
+ * @brief Сбрасывает префикс.
+ */
+void TypingSession::reset() {
+  text.clear();
+  levels.clear();
+  levels.push_back({trie->getRoot(), 0, {}, false});
+}
+
+/**
+ * @brief Добавляет символы к префиксу.
+ * @details Символ вне алфавита делает префикс «пустым» (NO_NODE), но
+ * остаётся в стеке, чтобы его можно было стереть.
+ * @param symbols Строка UTF-8.
+ */
+void TypingSession::type(std::string_view symbols) {
+  for (std::size_t position = 0; position < symbols.size();) {
+    std::size_t start = position;
+    int index = DefaultAlphabet::nextIndex(symbols, position);
+    // Обрезанная последовательность в конце строки считается одним символом.
+    if (position == start || position > symbols.size())
+      position = symbols.size();
+    text.append(symbols.data() + start, position - start);
+
+    NodeId node = levels.back().node;
+    if (node != NO_NODE)
+      node = index == -1 ? NO_NODE : trie->arena.getChild(node, index);
+    levels.push_back({node, text.size(), {}, false});
+  }
+}
+
+/**
+ * @brief Стирает последний символ.
+ * @return false, если префикс уже пуст.
+ */
+bool TypingSession::backspace() {
+  if (levels.size() == 1)
+    return false;
+  levels.pop_back();
+  text.resize(levels.back().prefixLen);
+  return true;
+}
+
+/**
+ * @brief Переводит сессию на новый префикс.
+ * @param prefix Новый префикс.
+ */
+void TypingSession::assign(std::string_view prefix) {
+  std::size_t common = 0;
+  while (common < text.size() && common < prefix.size() && text[common] == prefix[common])
+    ++common;
+
+  while (levels.back().prefixLen > common)
+    backspace();
+  type(prefix.substr(levels.back().prefixLen));
+}
+
+/**
+ * @brief Число слов с текущим префиксом.
+ * @return Количество слов.
+ */
+std::size_t TypingSession::count() const {
+  NodeId node = levels.back().node;
+  return node == NO_NODE ? 0 : trie->arena.node(node).words;
+}
+
+/**
+ * @brief Проверяет, является ли префикс словом словаря.
+ * @return true, если слово найдено.
+ */
+bool TypingSession::isWord() const {
+  NodeId node = levels.back().node;
+  return levels.size() > 1 && node != NO_NODE && trie->arena.node(node).isEndOfWord;
+}
+
+/**
+ * @brief Лучшие подсказки для текущего префикса.
+ * @details Подсказки нового префикса — подмножество слов предыдущего.
+ * Если все k лучших слов предыдущего префикса продолжают новый (или их
+ * было меньше k, то есть это все слова), то они же — лучшие и для нового.
+ * Проверяются только байты последнего символа. Иначе выполняется поиск
+ * «лучший-первым» от узла префикса.
+ * @return Ссылка на подсказки.
+ */
+const std::vector<std::string> &TypingSession::top() {
+  Level &current = levels.back();
+  if (current.topReady)
+    return current.top;
+
+  current.topReady = true;
+  if (current.node == NO_NODE)
+    return current.top;
+
+  if (levels.size() > 1) {
+    Level &previous = levels[levels.size() - 2];
+    if (previous.topReady) {
+      std::string_view symbol(text.data() + previous.prefixLen,
+                              current.prefixLen - previous.prefixLen);
+      for (const std::string &word : previous.top)
+        if (word.compare(previous.prefixLen, symbol.size(), symbol) == 0)
+          current.top.push_back(word);
+
+      if (current.top.size() == previous.top.size() || previous.top.size() < limit)
+        return current.top;
+    }
+  }
+
+  trie->collectTop(current.node, text, limit, current.top);
+  return current.top;
+}
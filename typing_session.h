@@ -0,0 +1,103 @@
+/**
+ * @file typing_session.h
+ * @brief Сессия набора: подсказки, обновляемые по одному символу.
+ */
+
+#pragma once
+
+#include "node_arena.h"
+#include "prefix_tree.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/**
+ * @class TypingSession
+ * @brief Текущий префикс набираемого слова со стеком пройденных узлов.
+ *
+ * @details Каждый набранный символ — уровень стека: узел дерева, длина
+ * префикса и лениво вычисленные лучшие подсказки. Добавление символа —
+ * один переход от узла вершины стека, стирание — снятие уровня, при
+ * котором подсказки предыдущего префикса уже готовы. Новые подсказки
+ * сначала ищутся среди подсказок предыдущего уровня: если все они
+ * продолжают новый префикс (или их было меньше k), они и есть ответ, и
+ * дерево не обходится. Стоимость нажатия не зависит от длины префикса.
+ * Сессия становится недействительной после любого изменения дерева.
+ */
+class TypingSession {
+private:
+  /**
+   * @struct Level
+   * @brief Состояние после очередного символа.
+   */
+  struct Level {
+    NodeId node;                  ///< Узел префикса (NO_NODE — слов нет)
+    std::size_t prefixLen;        ///< Длина префикса в байтах
+    std::vector<std::string> top; ///< Лучшие подсказки (если вычислены)
+    bool topReady;                ///< Подсказки вычислены
+  };
+
+  const Trie *trie;          ///< Дерево
+  std::size_t limit;         ///< Число подсказок
+  std::vector<Level> levels; ///< Стек уровней (нулевой — корень)
+  std::string text;          ///< Набранный префикс
+
+public:
+  /**
+   * @brief Конструктор. Начинает сессию с пустым префиксом.
+   * @param trie Дерево
+   * @param k Число подсказок
+   */
+  explicit TypingSession(const Trie &trie, std::size_t k = 5);
+
+  /**
+   * @brief Добавляет символы к префиксу, каждый — отдельным уровнем.
+   * @param symbols Строка UTF-8 (обычно один символ)
+   */
+  void type(std::string_view symbols);
+
+  /**
+   * @brief Стирает последний символ.
+   * @return false, если префикс уже пуст
+   */
+  bool backspace();
+
+  /**
+   * @brief Переводит сессию на новый префикс.
+   * @details Общая с текущим префиксом часть сохраняется, стираются и
+   * набираются только отличающиеся символы.
+   * @param prefix Новый префикс
+   */
+  void assign(std::string_view prefix);
+
+  /**
+   * @brief Сбрасывает префикс.
+   */
+  void reset();
+
+  /**
+   * @brief Текущий префикс.
+   * @return Набранная строка
+   */
+  const std::string &prefix() const { return text; }
+
+  /**
+   * @brief Число слов с текущим префиксом.
+   * @return Количество слов
+   */
+  std::size_t count() const;
+
+  /**
+   * @brief Проверяет, является ли префикс словом словаря.
+   * @return true, если слово найдено
+   */
+  bool isWord() const;
+
+  /**
+   * @brief Лучшие подсказки для текущего префикса (по убыванию веса).
+   * @return Ссылка на подсказки, действительная до следующего изменения префикса
+   */
+  const std::vector<std::string> &top();
+};
@@ -0,0 +1,353 @@
+/**
+ * @file utf8_text.cpp
+ * @brief Проверка и нормализация UTF-8: SSE2 и скалярный варианты.
+ */
+
+#include "utf8_text.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define T9_UTF8_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+/**
+ * @brief Нормализует один байт по соседним байтам.
+ *
+ * @details Все замены затрагивают либо ASCII, либо пару "ведущий байт
+ * D0/D1/D2 + байт продолжения". Решение для каждого байта зависит только от
+ * него и соседей, поэтому скалярный и векторный варианты совпадают на любом
+ * входе.
+ *
+ * @param prev Предыдущий байт (0 в начале текста).
+ * @param cur Текущий байт.
+ * @param next Следующий байт (0 в конце текста).
+ * @param foldYo Заменять ё на е.
+ * @return Новый байт.
+ */
+unsigned char normalizeByte(unsigned char prev, unsigned char cur, unsigned char next,
+                            bool foldYo) {
+  if (cur >= 'A' && cur <= 'Z')
+    return cur + 0x20;
+
+  if (cur == 0xD0) {
+    // Ѐ-Џ (кроме Ё при замене) и Р-Я переходят в строку D1.
+    if (foldYo && next == 0x81)
+      return cur;
+    if ((next >= 0x80 && next <= 0x8F) || (next >= 0xA0 && next <= 0xAF))
+      return 0xD1;
+    return cur;
+  }
+  if (cur == 0xD1)
+    return foldYo && next == 0x91 ? 0xD0 : cur;
+
+  if (prev == 0xD0) {
+    if (foldYo && cur == 0x81)
+      return 0xB5;
+    if (cur >= 0x80 && cur <= 0x8F)
+      return cur + 0x10;
+    if (cur >= 0x90 && cur <= 0x9F)
+      return cur + 0x20;
+    if (cur >= 0xA0 && cur <= 0xAF)
+      return cur - 0x20;
+    return cur;
+  }
+  if (prev == 0xD1)
+    return foldYo && cur == 0x91 ? 0xB5 : cur;
+  if (prev == 0xD2)
+    return cur == 0x90 ? 0x91 : cur;
+  return cur;
+}
+
+#ifdef T9_UTF8_SSE2
+
+/**
+ * @brief Маска байтов из диапазона [lo, hi] (без учёта знака).
+ * @param v Байты.
+ * @param lo Нижняя граница.
+ * @param hi Верхняя граница.
+ * @return 0xFF для байтов из диапазона, иначе 0.
+ */
+inline __m128i inRange(__m128i v, unsigned char lo, unsigned char hi) {
+  __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(static_cast<char>(lo)));
+  return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(static_cast<char>(hi - lo))),
+                        shifted);
+}
+
+/**
+ * @brief Маска байтов, равных значению.
+ * @param v Байты.
+ * @param value Значение.
+ * @return 0xFF для равных байтов, иначе 0.
+ */
+inline __m128i equal(__m128i v, unsigned char value) {
+  return _mm_cmpeq_epi8(v, _mm_set1_epi8(static_cast<char>(value)));
+}
+
+/**
+ * @brief Байты блока, сдвинутые на N позиций назад с подстановкой хвоста
+ * предыдущего блока.
+ * @param cur Текущий блок.
+ * @param prev Предыдущий блок.
+ * @return Байт i результата — байт i - N общего потока.
+ */
+template <int N> inline __m128i previous(__m128i cur, __m128i prev) {
+  return _mm_or_si128(_mm_slli_si128(cur, N), _mm_srli_si128(prev, 16 - N));
+}
+
+/**
+ * @class Utf8Checker
+ * @brief Проверка UTF-8 блоками по 16 байт.
+ *
+ * @details Для каждого байта вычисляется, обязан ли он быть байтом
+ * продолжения (по ведущим байтам на 1-3 позиции раньше), и сравнивается с
+ * тем, чем он является. Отдельно проверяются запрещённые байты и второй
+ * байт после E0, ED, F0 и F4. Ошибки копятся в одном регистре.
+ */
+class Utf8Checker {
+private:
+  __m128i _prev = _mm_setzero_si128();  ///< Предыдущий блок
+  __m128i _error = _mm_setzero_si128(); ///< Накопленные ошибки
+
+public:
+  /**
+   * @brief Проверяет очередной блок.
+   * @param cur Блок из 16 байт.
+   */
+  void check(__m128i cur) {
+    if (_mm_movemask_epi8(_mm_or_si128(cur, _prev)) == 0) {
+      _prev = cur;
+      return;
+    }
+
+    __m128i prev1 = previous<1>(cur, _prev);
+    __m128i prev2 = previous<2>(cur, _prev);
+    __m128i prev3 = previous<3>(cur, _prev);
+
+    __m128i need = _mm_or_si128(inRange(prev1, 0xC0, 0xFF),
+                                _mm_or_si128(inRange(prev2, 0xE0, 0xFF), inRange(prev3, 0xF0, 0xFF)));
+    __m128i error = _mm_xor_si128(need, inRange(cur, 0x80, 0xBF));
+    error = _mm_or_si128(error, inRange(cur, 0xC0, 0xC1));
+    error = _mm_or_si128(error, inRange(cur, 0xF5, 0xFF));
+    error = _mm_or_si128(error, _mm_and_si128(equal(prev1, 0xE0), inRange(cur, 0x80, 0x9F)));
+    error = _mm_or_si128(error, _mm_and_si128(equal(prev1, 0xED), inRange(cur, 0xA0, 0xBF)));
+    error = _mm_or_si128(error, _mm_and_si128(equal(prev1, 0xF0), inRange(cur, 0x80, 0x8F)));
+    error = _mm_or_si128(error, _mm_and_si128(equal(prev1, 0xF4), inRange(cur, 0x90, 0xBF)));
+
+    _error = _mm_or_si128(_error, error);
+    _prev = cur;
+  }
+
+  /**
+   * @brief Проверяет, были ли ошибки.
+   * @return true, если ошибок не было
+   */
+  bool valid() const { return _mm_movemask_epi8(_error) == 0; }
+};
+
+/**
+ * @brief Нормализует блок из 16 байт (векторный вариант normalizeByte).
+ * @param prev Байты со сдвигом на одну позицию назад.
+ * @param cur Байты блока.
+ * @param next Байты со сдвигом на одну позицию вперёд.
+ * @param foldYo Заменять ё на е.
+ * @return Нормализованный блок.
+ */
+inline __m128i normalizeChunk(__m128i prev, __m128i cur, __m128i next, bool foldYo) {
+  __m128i delta = _mm_and_si128(inRange(cur, 'A', 'Z'), _mm_set1_epi8(0x20));
+  if (_mm_movemask_epi8(cur) == 0)
+    return _mm_add_epi8(cur, delta);
+
+  // Маски выбора взаимно исключают друг друга, поэтому сдвиги объединяются по ИЛИ.
+  __m128i prevD0 = equal(prev, 0xD0);
+  __m128i leadUp = _mm_and_si128(equal(cur, 0xD0), _mm_or_si128(inRange(next, 0x80, 0x8F),
+                                                                  inRange(next, 0xA0, 0xAF)));
+  __m128i trail10 = _mm_and_si128(prevD0, inRange(cur, 0x80, 0x8F));
+  __m128i trail20 = _mm_and_si128(prevD0, inRange(cur, 0x90, 0x9F));
+  __m128i trailMinus20 = _mm_and_si128(prevD0, inRange(cur, 0xA0, 0xAF));
+  __m128i ghe = _mm_and_si128(equal(prev, 0xD2), equal(cur, 0x90));
+
+  if (foldYo) {
+    __m128i yoUpper = _mm_and_si128(prevD0, equal(cur, 0x81));
+    __m128i yoLower = _mm_and_si128(equal(prev, 0xD1), equal(cur, 0x91));
+    __m128i leadDown = _mm_and_si128(equal(cur, 0xD1), equal(next, 0x91));
+    leadUp = _mm_andnot_si128(equal(next, 0x81), leadUp);
+    trail10 = _mm_andnot_si128(yoUpper, trail10);
+    delta = _mm_or_si128(delta, _mm_and_si128(yoUpper, _mm_set1_epi8(0x34)));
+    delta = _mm_or_si128(delta, _mm_and_si128(yoLower, _mm_set1_epi8(0x24)));
+    delta = _mm_or_si128(delta, leadDown); // -1
+  }
+
+  delta = _mm_or_si128(delta, _mm_and_si128(leadUp, _mm_set1_epi8(1)));
+  delta = _mm_or_si128(delta, _mm_and_si128(trail10, _mm_set1_epi8(0x10)));
+  delta = _mm_or_si128(delta, _mm_and_si128(trail20, _mm_set1_epi8(0x20)));
+  delta = _mm_or_si128(delta, _mm_and_si128(trailMinus20, _mm_set1_epi8(-0x20)));
+  delta = _mm_or_si128(delta, _mm_and_si128(ghe, _mm_set1_epi8(1)));
+  return _mm_add_epi8(cur, delta);
+}
+
+#endif
+
+} // namespace
+
+/**
+ * @brief Скалярная проверка UTF-8.
+ * @param text Текст.
+ * @return true, если текст корректен.
+ */
+bool isValidUtf8Scalar(std::string_view text) {
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(text.data());
+  std::size_t size = text.size();
+
+  for (std::size_t i = 0; i < size;) {
+    unsigned char lead = bytes[i];
+    if (lead < 0x80) {
+      ++i;
+      continue;
+    }
+
+    std::size_t length;
+    unsigned char low = 0x80, high = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+      length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+      length = 3;
+      if (lead == 0xE0)
+        low = 0xA0;
+      else if (lead == 0xED)
+        high = 0x9F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+      length = 4;
+      if (lead == 0xF0)
+        low = 0x90;
+      else if (lead == 0xF4)
+        high = 0x8F;
+    } else {
+      return false;
+    }
+
+    if (size - i < length || bytes[i + 1] < low || bytes[i + 1] > high)
+      return false;
+    for (std::size_t k = 2; k < length; ++k)
+      if ((bytes[i + k] & 0xC0) != 0x80)
+        return false;
+    i += length;
+  }
+  return true;
+}
+
+/**
+ * @brief Проверяет, что текст — корректный UTF-8.
+ * @param text Текст.
+ * @return true, если текст корректен.
+ */
+bool isValidUtf8(std::string_view text) {
+#ifdef T9_UTF8_SSE2
+  Utf8Checker checker;
+  std::size_t i = 0;
+  for (; i + 16 <= text.size(); i += 16)
+    checker.check(_mm_loadu_si128(reinterpret_cast<const __m128i *>(text.data() + i)));
+
+  // Хвост дополняется нулями; ещё один нулевой блок ловит обрыв
+  // последовательности в последних байтах.
+  alignas(16) char tail[16] = {};
+  std::memcpy(tail, text.data() + i, text.size() - i);
+  checker.check(_mm_load_si128(reinterpret_cast<const __m128i *>(tail)));
+  checker.check(_mm_setzero_si128());
+  return checker.valid();
+#else
+  return isValidUtf8Scalar(text);
+#endif
+}
+
+/**
+ * @brief Скалярная нормализация текста.
+ * @param text Исходный текст.
+ * @param out Результат.
+ * @param options Параметры нормализации.
+ */
+void normalizeTextScalar(std::string_view text, std::string &out,
+                         const NormalizeOptions &options) {
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(text.data());
+  std::size_t size = text.size();
+  out.resize(size);
+
+  for (std::size_t i = 0; i < size; ++i) {
+    unsigned char prev = i > 0 ? bytes[i - 1] : 0;
+    unsigned char next = i + 1 < size ? bytes[i + 1] : 0;
+    out[i] = static_cast<char>(normalizeByte(prev, bytes[i], next, options.foldYo));
+  }
+}
+
+/**
+ * @brief Приводит латиницу и кириллицу к нижнему регистру.
+ * @param text Исходный текст.
+ * @param out Результат.
+ * @param options Параметры нормализации.
+ */
+void normalizeText(std::string_view text, std::string &out, const NormalizeOptions &options) {
+#ifdef T9_UTF8_SSE2
+  std::size_t size = text.size();
+  if (size < 18) {
+    normalizeTextScalar(text, out, options);
+    return;
+  }
+
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(text.data());
+  out.resize(size);
+  char *result = &out[0];
+
+  // Блоку нужны соседние байты слева и справа: первый байт и хвост
+  // обрабатываются скалярно.
+  result[0] = static_cast<char>(normalizeByte(0, bytes[0], bytes[1], options.foldYo));
+  std::size_t i = 1;
+  for (; i + 17 <= size; i += 16) {
+    __m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i - 1));
+    __m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i));
+    __m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i + 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(result + i),
+                     normalizeChunk(prev, cur, next, options.foldYo));
+  }
+  for (; i < size; ++i) {
+    unsigned char next = i + 1 < size ? bytes[i + 1] : 0;
+    result[i] = static_cast<char>(normalizeByte(bytes[i - 1], bytes[i], next, options.foldYo));
+  }
+#else
+  normalizeTextScalar(text, out, options);
+#endif
+}
+
+/**
+ * @brief Нормализует одно слово или запрос.
+ * @param text Исходный текст.
+ * @param options Параметры нормализации.
+ * @return Нормализованный текст.
+ */
+std::string normalizeWord(std::string_view text, const NormalizeOptions &options) {
+  std::string result;
+  normalizeText(text, result, options);
+  return result;
+}
+
+/**
+ * @brief Разбирает вес слова (частоту) из текстового поля.
+ * @param field Поле без окружающих пробелов.
+ * @param weight Результат.
+ * @return false, если поле не является неотрицательным числом.
+ */
+bool parseWeight(std::string_view field, std::uint32_t &weight) {
+  if (field.empty())
+    return false;
+  std::uint64_t value = 0;
+  for (char c : field) {
+    if (c < '0' || c > '9')
+      return false;
+    value = value * 10 + static_cast<std::uint64_t>(c - '0');
+    if (value > UINT32_MAX)
+      return false;
+  }
+  weight = static_cast<std::uint32_t>(value);
+  return true;
+}
@@ -0,0 +1,82 @@
+/**
+ * @file utf8_text.h
+ * @brief Проверка и нормализация текста UTF-8 перед вставкой в словарь.
+ *
+ * @details Функции работают над целыми буферами (файл списка слов целиком)
+ * и обрабатывают по 16 байт за шаг инструкциями SSE2, которые есть у любого
+ * x86-64. На других архитектурах используется скалярный вариант с тем же
+ * результатом. Скалярные варианты доступны и напрямую — для сравнения.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @struct NormalizeOptions
+ * @brief Параметры нормализации.
+ */
+struct NormalizeOptions {
+  bool foldYo = false; ///< Заменять ё на е (и Ё на е)
+};
+
+/**
+ * @brief Проверяет, что текст — корректный UTF-8.
+ * @details Отвергаются обрывы последовательностей, лишние байты
+ * продолжения, избыточные (overlong) формы, суррогаты и кодовые точки
+ * выше U+10FFFF.
+ * @param text Текст
+ * @return true, если текст корректен
+ */
+bool isValidUtf8(std::string_view text);
+
+/**
+ * @brief Скалярный вариант isValidUtf8.
+ * @param text Текст
+ * @return true, если текст корректен
+ */
+bool isValidUtf8Scalar(std::string_view text);
+
+/**
+ * @brief Приводит латиницу и кириллицу к нижнему регистру.
+ *
+ * @details Заменяются A-Z, А-Я, Ѐ-Џ (в том числе Ё, Є, І, Ї) и Ґ, при
+ * foldYo ещё ё и Ё на е. Все замены сохраняют длину в байтах, поэтому
+ * границы строк и слов не сдвигаются. Остальные байты копируются как
+ * есть; на некорректном UTF-8 функция безопасна, но смысла не имеет.
+ *
+ * @param text Исходный текст
+ * @param out Результат (перезаписывается, размер равен размеру text)
+ * @param options Параметры нормализации
+ */
+void normalizeText(std::string_view text, std::string &out, const NormalizeOptions &options = {});
+
+/**
+ * @brief Скалярный вариант normalizeText.
+ * @param text Исходный текст
+ * @param out Результат
+ * @param options Параметры нормализации
+ */
+void normalizeTextScalar(std::string_view text, std::string &out,
+                         const NormalizeOptions &options = {});
+
+/**
+ * @brief Нормализует одно слово или запрос.
+ * @param text Исходный текст
+ * @param options Параметры нормализации
+ * @return Нормализованный текст
+ */
+std::string normalizeWord(std::string_view text, const NormalizeOptions &options = {});
+
+/**
+ * @brief Разбирает вес слова (частоту) из текстового поля.
+ * @details Поле должно состоять только из десятичных цифр и помещаться в
+ * 32 бита; знак, пробелы внутри и прочие символы отвергаются.
+ * @param field Поле без окружающих пробелов
+ * @param weight Результат (не меняется при ошибке)
+ * @return false, если поле не является неотрицательным числом
+ */
+bool parseWeight(std::string_view field, std::uint32_t &weight);
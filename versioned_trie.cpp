@@ -0,0 +1,429 @@
+/**
+ * @file versioned_trie.cpp
+ * @brief Реализация версионного дерева и эпохальной реклемации.
+ */
+
+#include "versioned_trie.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <thread>
+
+// === EpochManager ===
+
+/**
+ * @brief Деструктор. Удаляет все ожидающие узлы.
+ */
+EpochManager::~EpochManager() {
+  for (auto &entry : retired)
+    delete entry.second;
+}
+
+/**
+ * @brief Входит в чтение: занимает слот и фиксирует эпоху.
+ * @details Одного прохода по слотам достаточно: если все заняты, ожидание
+ * освобождения могло бы длиться вечно (например, когда все снимки открыл
+ * сам этот поток), поэтому читатель уходит в переполненный слот.
+ * @return Номер занятого слота (MAX_READERS — переполненный слот).
+ */
+int EpochManager::enter() {
+  static thread_local int hint =
+      static_cast<int>(std::hash<std::thread::id>()(std::this_thread::get_id()) % MAX_READERS);
+
+  for (int i = 0; i < MAX_READERS; ++i) {
+    int slot = (hint + i) % MAX_READERS;
+    bool expected = false;
+    if (!slots[slot].used.load(std::memory_order_relaxed) &&
+        slots[slot].used.compare_exchange_strong(expected, true)) {
+      slots[slot].epoch.store(globalEpoch.load());
+      hint = slot;
+      return slot;
+    }
+  }
+
+  // Эпохи читателей переполненного слота не убывают, поэтому сохраняется
+  // эпоха первого из них: она не позже эпохи любого другого.
+  std::lock_guard<std::mutex> lock(overflowMutex);
+  if (overflowReaders++ == 0)
+    overflowEpoch.store(globalEpoch.load());
+  return MAX_READERS;
+}
+
+/**
+ * @brief Выходит из чтения и освобождает слот.
+ * @param slot Номер слота.
+ */
+void EpochManager::leave(int slot) {
+  if (slot == MAX_READERS) {
+    std::lock_guard<std::mutex> lock(overflowMutex);
+    if (--overflowReaders == 0)
+      overflowEpoch.store(IDLE, std::memory_order_release);
+    return;
+  }
+  slots[slot].epoch.store(IDLE, std::memory_order_release);
+  slots[slot].used.store(false, std::memory_order_release);
+}
+
+/**
+ * @brief Откладывает удаление вытесненных узлов.
+ * @param nodes Узлы, недостижимые из новой версии.
+ */
+void EpochManager::retire(std::vector<const PersistentNode *> &nodes) {
+  std::uint64_t epoch = globalEpoch.fetch_add(1);
+  for (const PersistentNode *node : nodes)
+    retired.emplace_back(epoch, node);
+  nodes.clear();
+}
+
+/**
+ * @brief Удаляет узлы, которые уже не может видеть ни один читатель.
+ * @return Число удалённых узлов.
+ */
+std::size_t EpochManager::collect() {
+  std::uint64_t oldest = overflowEpoch.load();
+  for (int i = 0; i < MAX_READERS; ++i)
+    oldest = std::min(oldest, slots[i].epoch.load());
+
+  std::size_t kept = 0, freed = 0;
+  for (auto &entry : retired) {
+    if (entry.first < oldest) {
+      delete entry.second;
+      ++freed;
+    } else {
+      retired[kept++] = entry;
+    }
+  }
+  retired.resize(kept);
+  return freed;
+}
+
+// === VersionedTrie ===
+
+/**
+ * @brief Конструктор. Создаёт пустое дерево.
+ */
+VersionedTrie::VersionedTrie() : root(new PersistentNode()) {}
+
+/**
+ * @brief Деструктор. Удаляет текущую версию (ожидающие узлы удалит EpochManager).
+ */
+VersionedTrie::~VersionedTrie() { deleteSubTrie(root.load()); }
+
+/**
+ * @brief Рекурсивно удаляет поддерево.
+ * @param node Корень поддерева.
+ */
+void VersionedTrie::deleteSubTrie(const PersistentNode *node) {
+  if (!node)
+    return;
+  for (const PersistentNode *child : node->children)
+    deleteSubTrie(child);
+  delete node;
+}
+
+/**
+ * @brief Копирует узел (потомки разделяются с оригиналом).
+ * @param node Исходный узел или nullptr.
+ * @return Новый изменяемый узел.
+ */
+PersistentNode *VersionedTrie::copyNode(const PersistentNode *node) {
+  return node ? new PersistentNode(*node) : new PersistentNode();
+}
+
+/**
+ * @brief Пересчитывает наибольший вес поддерева копии узла.
+ * @param node Узел.
+ */
+void VersionedTrie::refreshMaxWeight(PersistentNode *node) {
+  std::uint32_t best = node->isEndOfWord ? node->weight : 0;
+  for (const PersistentNode *child : node->children)
+    best = std::max(best, child->maxWeight);
+  node->maxWeight = best;
+}
+
+/**
+ * @brief Заменяет, добавляет или убирает потомка в копии узла.
+ * @param node Копия узла.
+ * @param index Индекс символа.
+ * @param child Новый потомок или nullptr для удаления.
+ */
+void VersionedTrie::setChild(PersistentNode *node, int index, const PersistentNode *child) {
+  std::uint64_t bit = std::uint64_t(1) << index;
+  auto slot = node->children.begin() + popcount64(node->childMask & (bit - 1));
+
+  if (node->childMask & bit) {
+    if (child) {
+      *slot = child;
+    } else {
+      node->children.erase(slot);
+      node->childMask &= ~bit;
+    }
+  } else if (child) {
+    node->children.insert(slot, child);
+    node->childMask |= bit;
+  }
+}
+
+/**
+ * @brief Публикует новый корень и передаёт старые узлы на реклемацию.
+ * @param newRoot Новый корень.
+ * @param replaced Узлы старой версии, не вошедшие в новую.
+ */
+void VersionedTrie::publish(const PersistentNode *newRoot,
+                            std::vector<const PersistentNode *> &replaced) {
+  root.store(newRoot);
+  epochs.retire(replaced);
+  epochs.collect();
+}
+
+/**
+ * @brief Вставляет слово, публикуя новую версию.
+ * @param word Слово.
+ * @param weight Вес слова.
+ * @return false, если слово пустое или содержит символы не из алфавита.
+ */
+bool VersionedTrie::insert(std::string_view word, std::uint32_t weight) {
+  if (word.empty())
+    return false;
+
+  std::vector<int> indices;
+  for (std::size_t pos = 0; pos < word.size();) {
+    int index = DefaultAlphabet::nextIndex(word, pos);
+    if (index == -1)
+      return false;
+    indices.push_back(index);
+  }
+
+  std::lock_guard<std::mutex> lock(writeMutex);
+
+  std::vector<const PersistentNode *> path{root.load()};
+  for (int index : indices)
+    path.push_back(path.back() ? path.back()->getChild(index) : nullptr);
+
+  PersistentNode *leaf = copyNode(path.back());
+  leaf->isEndOfWord = true;
+  leaf->weight = weight;
+  refreshMaxWeight(leaf);
+
+  const PersistentNode *child = leaf;
+  for (std::size_t k = indices.size(); k-- > 0;) {
+    PersistentNode *copy = copyNode(path[k]);
+    setChild(copy, indices[k], child);
+    refreshMaxWeight(copy);
+    child = copy;
+  }
+
+  std::vector<const PersistentNode *> replaced;
+  for (const PersistentNode *node : path)
+    if (node)
+      replaced.push_back(node);
+  publish(child, replaced);
+  return true;
+}
+
+/**
+ * @brief Удаляет слово, публикуя новую версию.
+ * @param word Слово.
+ * @return false, если слова не было.
+ */
+bool VersionedTrie::delWord(std::string_view word) {
+  std::vector<int> indices;
+  for (std::size_t pos = 0; pos < word.size();) {
+    int index = DefaultAlphabet::nextIndex(word, pos);
+    if (index == -1)
+      return false;
+    indices.push_back(index);
+  }
+
+  std::lock_guard<std::mutex> lock(writeMutex);
+
+  std::vector<const PersistentNode *> path{root.load()};
+  for (int index : indices) {
+    const PersistentNode *next = path.back()->getChild(index);
+    if (!next)
+      return false;
+    path.push_back(next);
+  }
+  if (!path.back()->isEndOfWord)
+    return false;
+
+  std::vector<const PersistentNode *> replaced(path.begin(), path.end());
+
+  PersistentNode *leaf = copyNode(path.back());
+  leaf->isEndOfWord = false;
+  leaf->weight = 0;
+  refreshMaxWeight(leaf);
+
+  const PersistentNode *child = leaf;
+  if (leaf->childMask == 0 && !indices.empty()) {
+    delete leaf;
+    child = nullptr;
+  }
+
+  for (std::size_t k = indices.size(); k-- > 0;) {
+    PersistentNode *copy = copyNode(path[k]);
+    setChild(copy, indices[k], child);
+    refreshMaxWeight(copy);
+    child = copy;
+    if (k > 0 && copy->childMask == 0 && !copy->isEndOfWord) {
+      delete copy;
+      child = nullptr;
+    }
+  }
+
+  publish(child, replaced);
+  return true;
+}
+
+/**
+ * @brief Число вытесненных узлов, ещё не удалённых.
+ * @return Размер списка ожидания реклемации.
+ */
+std::size_t VersionedTrie::pendingReclaim() const {
+  std::lock_guard<std::mutex> lock(writeMutex);
+  return epochs.pending();
+}
+
+// === VersionedTrie::Snapshot ===
+
+/**
+ * @brief Конструктор. Входит в эпоху и фиксирует текущий корень.
+ * @param owner Дерево.
+ */
+VersionedTrie::Snapshot::Snapshot(const VersionedTrie &owner)
+    : epochs(&owner.epochs), slot(owner.epochs.enter()), root(owner.root.load()) {}
+
+/**
+ * @brief Конструктор перемещения.
+ * @param other Перемещаемый снимок.
+ */
+VersionedTrie::Snapshot::Snapshot(Snapshot &&other) noexcept
+    : epochs(other.epochs), slot(other.slot), root(other.root) {
+  other.epochs = nullptr;
+}
+
+/**
+ * @brief Деструктор. Выходит из эпохи.
+ */
+VersionedTrie::Snapshot::~Snapshot() {
+  if (epochs)
+    epochs->leave(slot);
+}
+
+/**
+ * @brief Спускается по префиксу.
+ * @param key Префикс.
+ * @return Узел префикса или nullptr.
+ */
+const PersistentNode *VersionedTrie::Snapshot::walkPrefix(std::string_view key) const {
+  const PersistentNode *node = root;
+  for (std::size_t pos = 0; node && pos < key.size();) {
+    int index = DefaultAlphabet::nextIndex(key, pos);
+    if (index == -1)
+      return nullptr;
+    node = node->getChild(index);
+  }
+  return node;
+}
+
+/**
+ * @brief Рекурсивно собирает слова поддерева.
+ * @param node Текущий узел.
+ * @param path Буфер пути.
+ * @param results Вектор результатов.
+ */
+void VersionedTrie::Snapshot::collect(const PersistentNode *node, std::string &path,
+                                      std::vector<std::string> &results) const {
+  if (node->isEndOfWord)
+    results.push_back(path);
+
+  std::size_t len = path.size();
+  int slot = 0;
+  for (std::uint64_t mask = node->childMask; mask; mask &= mask - 1, ++slot) {
+    path += DefaultAlphabet::symbol(lowestBit64(mask));
+    collect(node->children[slot], path, results);
+    path.resize(len);
+  }
+}
+
+/**
+ * @brief Проверяет наличие полного слова.
+ * @param key Искомое слово.
+ * @return true, если слово есть в версии.
+ */
+bool VersionedTrie::Snapshot::findOneByKey(std::string_view key) const {
+  if (key.empty())
+    return false;
+  const PersistentNode *node = walkPrefix(key);
+  return node && node->isEndOfWord;
+}
+
+/**
+ * @brief Находит все слова с префиксом.
+ * @param key Префикс.
+ * @param results Вектор найденных слов.
+ */
+void VersionedTrie::Snapshot::findAllByKey(std::string_view key,
+                                           std::vector<std::string> &results) const {
+  results.clear();
+  const PersistentNode *node = walkPrefix(key);
+  if (!node)
+    return;
+
+  std::string path;
+  for (std::size_t pos = 0; pos < key.size();)
+    path += DefaultAlphabet::symbol(DefaultAlphabet::nextIndex(key, pos));
+  collect(node, path, results);
+}
+
+/**
+ * @brief Находит k слов с наибольшим весом среди слов с префиксом.
+ * @param key Префикс.
+ * @param k Наибольшее число результатов.
+ * @param results Вектор найденных слов.
+ */
+void VersionedTrie::Snapshot::findTopByKey(std::string_view key, std::size_t k,
+                                           std::vector<std::string> &results) const {
+  results.clear();
+  const PersistentNode *node = walkPrefix(key);
+  if (!node || k == 0)
+    return;
+
+  /// Кандидат очереди: поддерево (раскрыть) либо готовое слово (выдать).
+  struct Candidate {
+    std::uint32_t weight;
+    std::string word;
+    const PersistentNode *node;
+    bool isWord;
+
+    bool operator<(const Candidate &other) const {
+      if (weight != other.weight)
+        return weight < other.weight;
+      return word > other.word;
+    }
+  };
+
+  std::priority_queue<Candidate> queue;
+  queue.push({node->maxWeight, std::string(key), node, false});
+
+  while (!queue.empty() && results.size() < k) {
+    Candidate top = queue.top();
+    queue.pop();
+
+    if (top.isWord) {
+      results.push_back(std::move(top.word));
+      continue;
+    }
+
+    if (top.node->isEndOfWord)
+      queue.push({top.node->weight, top.word, top.node, true});
+
+    int slot = 0;
+    for (std::uint64_t mask = top.node->childMask; mask; mask &= mask - 1, ++slot) {
+      const PersistentNode *child = top.node->children[slot];
+      std::string word = top.word;
+      word += DefaultAlphabet::symbol(lowestBit64(mask));
+      queue.push({child->maxWeight, std::move(word), child, false});
+    }
+  }
+}
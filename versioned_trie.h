@@ -0,0 +1,312 @@
+/**
+ * @file versioned_trie.h
+ * @brief Версионное (copy-on-write) префиксное дерево для конкурентного чтения.
+ */
+
+#pragma once
+
+#include "alphabet.h"
+#include "node_arena.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @struct PersistentNode
+ * @brief Неизменяемый узел версионного дерева.
+ *
+ * @details После публикации узел не меняется: писатель копирует узлы на
+ * пути от корня к изменяемому слову, а нетронутые поддеревья разделяются
+ * между версиями.
+ */
+struct PersistentNode {
+  std::uint64_t childMask;                       ///< Маска присутствующих потомков
+  std::vector<const PersistentNode *> children;  ///< Плотный массив потомков
+  std::uint32_t weight;                          ///< Вес слова в узле
+  std::uint32_t maxWeight;                       ///< Наибольший вес в поддереве
+  bool isEndOfWord;                              ///< Признак конца слова
+
+  /**
+   * @brief Конструктор по умолчанию.
+   */
+  PersistentNode() : childMask(0), weight(0), maxWeight(0), isEndOfWord(false) {}
+
+  /**
+   * @brief Возвращает потомка по индексу символа.
+   * @param index Индекс символа в алфавите
+   * @return Указатель на потомка или nullptr
+   */
+  const PersistentNode *getChild(int index) const {
+    if (!(childMask & (std::uint64_t(1) << index)))
+      return nullptr;
+    return children[popcount64(childMask & ((std::uint64_t(1) << index) - 1))];
+  }
+};
+
+/**
+ * @class EpochManager
+ * @brief Эпохальная реклемация памяти для версионного дерева.
+ *
+ * @details Читатель при входе публикует в своём слоте текущую глобальную
+ * эпоху, при выходе — освобождает слот. Писатель помечает вытесненные узлы
+ * эпохой публикации и удаляет их только тогда, когда все активные читатели
+ * вошли в более позднюю эпоху, то есть заведомо видят новую версию.
+ *
+ * Слотов MAX_READERS. Если все заняты, читатель входит в общий
+ * переполненный слот: он защищён мьютексом и хранит счётчик читателей и
+ * эпоху самого раннего из них, пока счётчик не обнулится. Такой вход
+ * медленнее и может задерживать реклемацию, но никогда не ждёт.
+ */
+class EpochManager {
+public:
+  static constexpr int MAX_READERS = 128;                ///< Число слотов читателей
+  static constexpr std::uint64_t IDLE = ~std::uint64_t(0); ///< Слот не в чтении
+
+private:
+  /**
+   * @struct Slot
+   * @brief Слот читателя (на отдельной строке кэша).
+   */
+  struct alignas(64) Slot {
+    std::atomic<std::uint64_t> epoch{IDLE}; ///< Эпоха входа или IDLE
+    std::atomic<bool> used{false};          ///< Слот занят читателем
+  };
+
+  std::atomic<std::uint64_t> globalEpoch{1}; ///< Глобальная эпоха
+  Slot slots[MAX_READERS];                   ///< Слоты читателей
+  std::mutex overflowMutex;                  ///< Защищает переполненный слот
+  std::size_t overflowReaders = 0;           ///< Читателей в переполненном слоте
+  std::atomic<std::uint64_t> overflowEpoch{IDLE}; ///< Самая ранняя эпоха в нём или IDLE
+  std::vector<std::pair<std::uint64_t, const PersistentNode *>> retired; ///< Ожидают удаления
+
+public:
+  EpochManager() = default;
+  EpochManager(const EpochManager &) = delete;
+  EpochManager &operator=(const EpochManager &) = delete;
+
+  /**
+   * @brief Деструктор. Удаляет все ожидающие узлы.
+   */
+  ~EpochManager();
+
+  /**
+   * @brief Входит в чтение: занимает слот и фиксирует эпоху.
+   * @details Если свободных слотов нет, входит в переполненный слот и не
+   * ждёт.
+   * @return Номер занятого слота (MAX_READERS — переполненный слот)
+   */
+  int enter();
+
+  /**
+   * @brief Выходит из чтения и освобождает слот.
+   * @param slot Номер слота, полученный от enter()
+   */
+  void leave(int slot);
+
+  /**
+   * @brief Откладывает удаление вытесненных узлов (вызывает писатель).
+   * @param nodes Узлы, недостижимые из новой версии
+   */
+  void retire(std::vector<const PersistentNode *> &nodes);
+
+  /**
+   * @brief Удаляет узлы, которые уже не может видеть ни один читатель.
+   * @return Число удалённых узлов
+   */
+  std::size_t collect();
+
+  /**
+   * @brief Число узлов, ожидающих удаления.
+   * @return Размер списка ожидания
+   */
+  std::size_t pending() const { return retired.size(); }
+};
+
+/**
+ * @class VersionedTrie
+ * @brief Дерево со снимочной изоляцией: читатели без блокировок, писатели
+ * публикуют новые версии атомарной заменой корня.
+ *
+ * @details Писатели сериализуются мьютексом. Изменение копирует узлы от
+ * корня до изменённого узла, после чего новый корень публикуется атомарно.
+ * Читатель открывает Snapshot и до его закрытия работает с той версией,
+ * которую застал, не блокируясь писателями. Старые узлы освобождаются
+ * через EpochManager.
+ */
+class VersionedTrie {
+private:
+  std::atomic<const PersistentNode *> root; ///< Текущая опубликованная версия
+  mutable EpochManager epochs;              ///< Реклемация старых версий
+  mutable std::mutex writeMutex;            ///< Сериализация писателей
+
+  /**
+   * @brief Копирует узел (потомки разделяются с оригиналом).
+   * @param node Исходный узел или nullptr
+   * @return Новый изменяемый узел
+   */
+  static PersistentNode *copyNode(const PersistentNode *node);
+
+  /**
+   * @brief Пересчитывает наибольший вес поддерева копии узла.
+   * @param node Узел
+   */
+  static void refreshMaxWeight(PersistentNode *node);
+
+  /**
+   * @brief Заменяет (или добавляет, или убирает) потомка в копии узла.
+   * @param node Копия узла
+   * @param index Индекс символа
+   * @param child Новый потомок или nullptr для удаления
+   */
+  static void setChild(PersistentNode *node, int index, const PersistentNode *child);
+
+  /**
+   * @brief Рекурсивно удаляет поддерево.
+   * @param node Корень поддерева
+   */
+  static void deleteSubTrie(const PersistentNode *node);
+
+  /**
+   * @brief Публикует новый корень и передаёт старые узлы на реклемацию.
+   * @param newRoot Новый корень
+   * @param replaced Узлы старой версии, не вошедшие в новую
+   */
+  void publish(const PersistentNode *newRoot, std::vector<const PersistentNode *> &replaced);
+
+public:
+  /**
+   * @class Snapshot
+   * @brief Версия дерева, зафиксированная на время чтения (RAII).
+   * @details Каждый открытый снимок занимает слот читателя. Первые
+   * EpochManager::MAX_READERS одновременно открытых снимков (во всех
+   * потоках вместе) входят без блокировок, остальные — через общий
+   * переполненный слот под мьютексом; пока он занят, освобождение старых
+   * версий откладывается до эпохи самого раннего из его читателей.
+   */
+  class Snapshot {
+  private:
+    EpochManager *epochs;        ///< Менеджер эпох
+    int slot;                    ///< Занятый слот читателя
+    const PersistentNode *root;  ///< Корень зафиксированной версии
+
+    /**
+     * @brief Спускается по префиксу.
+     * @param key Префикс
+     * @return Узел префикса или nullptr
+     */
+    const PersistentNode *walkPrefix(std::string_view key) const;
+
+    /**
+     * @brief Рекурсивно собирает слова поддерева.
+     * @param node Текущий узел
+     * @param path Буфер пути
+     * @param results Вектор результатов
+     */
+    void collect(const PersistentNode *node, std::string &path,
+                 std::vector<std::string> &results) const;
+
+  public:
+    /**
+     * @brief Конструктор. Входит в эпоху и фиксирует текущий корень.
+     * @param owner Дерево
+     */
+    explicit Snapshot(const VersionedTrie &owner);
+
+    /**
+     * @brief Деструктор. Выходит из эпохи.
+     */
+    ~Snapshot();
+
+    Snapshot(const Snapshot &) = delete;
+    Snapshot &operator=(const Snapshot &) = delete;
+    Snapshot(Snapshot &&other) noexcept;
+    Snapshot &operator=(Snapshot &&) = delete;
+
+    /**
+     * @brief Проверяет наличие полного слова.
+     * @param key Искомое слово
+     * @return true, если слово есть в версии
+     */
+    bool findOneByKey(std::string_view key) const;
+
+    /**
+     * @brief Находит все слова с префиксом (в порядке алфавита).
+     * @param key Префикс
+     * @param results Вектор найденных слов
+     */
+    void findAllByKey(std::string_view key, std::vector<std::string> &results) const;
+
+    /**
+     * @brief Находит k слов с наибольшим весом среди слов с префиксом.
+     * @param key Префикс
+     * @param k Наибольшее число результатов
+     * @param results Вектор найденных слов (по убыванию веса)
+     */
+    void findTopByKey(std::string_view key, std::size_t k,
+                      std::vector<std::string> &results) const;
+  };
+
+  /**
+   * @brief Конструктор. Создаёт пустое дерево.
+   */
+  VersionedTrie();
+
+  /**
+   * @brief Деструктор. Удаляет текущую версию и все ожидающие узлы.
+   * @details К моменту разрушения не должно быть открытых Snapshot.
+   */
+  ~VersionedTrie();
+
+  VersionedTrie(const VersionedTrie &) = delete;
+  VersionedTrie &operator=(const VersionedTrie &) = delete;
+
+  /**
+   * @brief Открывает снимок текущей версии для чтения.
+   * @return Снимок, действующий до своего разрушения
+   */
+  Snapshot snapshot() const { return Snapshot(*this); }
+
+  /**
+   * @brief Вставляет слово, публикуя новую версию.
+   * @details Пустое слово и слово с символами не из алфавита отвергаются,
+   * новая версия не публикуется.
+   * @param word Слово
+   * @param weight Вес слова
+   * @return false, если слово пустое или содержит символы не из алфавита
+   */
+  bool insert(std::string_view word, std::uint32_t weight = 1);
+
+  /**
+   * @brief Удаляет слово, публикуя новую версию.
+   * @details Узлы, которые больше не ведут ни к одному слову, отсекаются.
+   * @param word Слово
+   * @return false, если слова не было
+   */
+  bool delWord(std::string_view word);
+
+  /**
+   * @brief Проверяет наличие слова в текущей версии.
+   * @param key Искомое слово
+   * @return true, если слово найдено
+   */
+  bool findOneByKey(std::string_view key) const { return snapshot().findOneByKey(key); }
+
+  /**
+   * @brief Находит все слова с префиксом в текущей версии.
+   * @param key Префикс
+   * @param results Вектор найденных слов
+   */
+  void findAllByKey(std::string_view key, std::vector<std::string> &results) const {
+    snapshot().findAllByKey(key, results);
+  }
+
+  /**
+   * @brief Число вытесненных узлов, ещё не удалённых.
+   * @return Размер списка ожидания реклемации
+   */
+  std::size_t pendingReclaim() const;
+};